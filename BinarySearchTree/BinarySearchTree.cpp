@@ -1,6 +1,24 @@
 #include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <sstream>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
+#include <unordered_set>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 // (borrowed)
 #include "CSVparser.hpp"
@@ -52,11 +70,187 @@ struct Node {
 		data = bid;
 	}
 
-	// dtor
-	~Node() {
-		delete left;
-		delete right;
+	// dtor: children are owned (and freed) by the NodePool, not by their parent
+	~Node() {}
+};
+
+/**
+ * Pool allocator for tree nodes.
+ * Nodes are carved out of chunks and released nodes are recycled,
+ * so the pool owns every node and the tree only links them together.
+ */
+class NodePool {
+
+private:
+	// Nodes per chunk for single allocations
+	static const unsigned CHUNK_SIZE = 256;
+
+	// Every chunk ever allocated. Freed together by Clear()
+	vector<Node*> chunks;
+
+	// Unused nodes at the end of the newest chunk
+	Node* next;
+	unsigned remaining;
+
+	// Released nodes, chained through their left pointers
+	Node* freeList;
+
+public:
+	NodePool() : next { nullptr }, remaining { 0 }, freeList { nullptr } {}
+
+	// The pool owns its chunks, so it cannot be copied
+	NodePool(const NodePool&) = delete;
+	NodePool& operator=(const NodePool&) = delete;
+
+	~NodePool() { Clear(); }
+
+	Node* Acquire(const Bid& bid);
+	Node* AcquireBlock(unsigned count);
+	void Release(Node* node);
+	void Clear();
+};
+
+//============================================================================
+// Frozen (read-only) search index definition
+//============================================================================
+
+/**
+ * A read-only index over a sorted set of bids.
+ * The keys are stored in Eytzinger (BFS) order in one array, so a search
+ * walks down an implicit tree where the children of k are 2k and 2k + 1.
+ * The top levels share cache lines, the next levels can be prefetched,
+ * and the comparison feeds the index arithmetic instead of a branch.
+ */
+class FrozenBidIndex {
+
+private:
+	// Packed bidId prefixes in Eytzinger order. 1-based: keys[0] is unused
+	vector<uint64_t> keys;
+
+	// Parallel to keys: position of each key in the payload
+	vector<int> rank;
+
+	// The bids themselves, in sorted order
+	vector<Bid> payload;
+
+	static uint64_t PackKey(const string& bidId);
+	int Layout(int sortedIdx, unsigned k);
+
+public:
+	// Empty index
+	FrozenBidIndex() {}
+
+	// Index a vector of bids that is already sorted by bidId
+	explicit FrozenBidIndex(vector<Bid> sorted);
+
+	// Find a bid (nullptr if not found)
+	const Bid* Find(const string& bidId) const;
+
+	// Access to the sorted payload
+	const vector<Bid>& Sorted() const { return payload; }
+
+	int Size() const { return payload.size(); }
+};
+
+//============================================================================
+// Inverted title index definition
+//============================================================================
+
+/**
+ * Full-text index over bid titles.
+ * Each title is split into lower-case alphanumeric terms, and each term
+ * keeps a posting list of the documents (bids, numbered as they are
+ * added) containing it. Posting lists store the gaps between document
+ * numbers as varints, so common terms take about a byte per bid.
+ * The term dictionary is ordered, so "dell*" finds every term starting
+ * with "dell". Removed bids are marked and skipped at query time.
+ */
+class TitleIndex {
+
+private:
+
+	struct PostingList {
+		// Delta + varint encoded document numbers, ascending
+		vector<uint8_t> bytes;
+		uint32_t last = 0;
+		uint32_t count = 0;
+	};
+
+	map<string, PostingList> terms;
+
+	// Document number -> bid, and back
+	vector<string> bidIds;
+	vector<bool> removed;
+	unordered_map<string, uint32_t> docs;
+
+	static void Append(PostingList& list, uint32_t doc);
+	static vector<uint32_t> Decode(const PostingList& list);
+	vector<uint32_t> TermDocs(const string& word) const;
+
+public:
+	// Split text into lower-case alphanumeric terms
+	static vector<string> Tokenize(const string& text);
+
+	// Documents in both / either of two ascending lists
+	static vector<uint32_t> Intersect(const vector<uint32_t>& a, const vector<uint32_t>& b);
+	static vector<uint32_t> Unite(const vector<uint32_t>& a, const vector<uint32_t>& b);
+
+	void Add(const Bid& bid);
+	void Remove(const string& bidId);
+	void Clear();
+
+	// Words are ANDed, "OR" between two words unites them, a trailing * matches a prefix
+	vector<string> Search(const string& query) const;
+
+	size_t TermCount() const { return terms.size(); }
+	size_t PostingBytes() const;
+};
+
+//============================================================================
+// Secondary indexes: look bids up by fund, amount or title, not just bidId
+//============================================================================
+
+/**
+ * A query over bid fields; empty / infinite fields match anything
+ * (Copied from HashTable)
+ */
+struct BidQuery {
+	// Exact fund
+	string fund;
+	// Title starts with
+	string titlePrefix;
+	// Title contains (no index can answer this alone)
+	string titleContains;
+	// Inclusive amount range
+	double minAmount;
+	double maxAmount;
+
+	BidQuery() {
+		minAmount = -HUGE_VAL;
+		maxAmount = HUGE_VAL;
 	}
+
+	bool Matches(const Bid& bid) const;
+};
+
+/**
+ * Secondary indexes mapping field values to bidIds.
+ * The tree keeps one id per bid, so a fund's ids form a plain set.
+ * (Copied from HashTable)
+ */
+class BidIndexes {
+
+private:
+
+	unordered_map<string, unordered_set<string>> byFund;
+	multimap<double, string> byAmount;
+	multimap<string, string> byTitle;
+
+public:
+	void Add(const Bid& bid);
+	void Remove(const Bid& bid);
+	void Clear();
+	bool Candidates(const BidQuery& query, vector<string>& bidIds, string& indexUsed) const;
 };
 
 //============================================================================
@@ -72,42 +266,498 @@ class BinarySearchTree {
 private:
     Node* root;
 
-    Node* AddNode(Node* node, Bid bid);
+    // Owns every node in the tree
+    NodePool pool;
+
+    Node* AddNode(Node* node, const Bid& bid);
+    Node* BuildBalanced(Node* block, vector<Bid>& bids, int begin, int end);
     void Traverse(Node* node);
     Node* SearchNode(Node* node, string bidId);
-    Node* RemoveNode(Node* node, string bidId);
+    Node* RemoveNode(Node* node, const string& bidId);
+    void CollectInOrder(Node* node, vector<Bid>& bids);
+    void ScanNode(Node* node, const BidQuery& query, vector<Bid>& matches);
 
-    // See the recursion in the destructor
-    void DestroyRecursive(Node* node);
+    // Lookups by fields other than bidId
+    BidIndexes indexes;
 
 public:
     // Inlined default ctor
     BinarySearchTree() { root = nullptr; }
 
     // destructor
-    virtual ~BinarySearchTree() { DestroyRecursive(root); }
+    virtual ~BinarySearchTree() { Clear(); }
+
+    // Delete every node
+    void Clear();
+
+    // Replace the contents with a height-balanced tree of the given bids
+    void BuildFromSorted(vector<Bid>& bids);
 
     // Traverse the tree in order
     void InOrder() { Traverse(root); }
 
     // Insert a node
-    void Insert(Bid bid) { root = AddNode(root, bid); }
+    void Insert(Bid bid);
 
     // Delete a node
-    void Remove(string bidId) { root = RemoveNode(root, bidId); }
+    void Remove(const string& bidId);
 
     // Search for a bid
     Bid Search(string bidId);
+
+    // Search for a bid without copying it (nullptr if not found)
+    const Bid* Find(string bidId) { Node* node = SearchNode(root, bidId); return node ? &node->data : nullptr; }
+
+    // Find the bids matching a query, through an index where one applies
+    vector<Bid> Query(const BidQuery& query, string* plan = nullptr);
+
+    // Copy the bids out in order of bidId
+    vector<Bid> Export();
+
+    // Copy the bids into a read-only search index
+    FrozenBidIndex Freeze();
 };
 
+//============================================================================
+// Concurrent Binary Search Tree class definition
+//============================================================================
+
 /**
- * Helper function for the destructor
+ * Node struct for the concurrent tree.
+ * Each node carries its own lock, which guards its links and its data.
+ */
+struct ConcurrentNode {
+	Bid data;
+
+	ConcurrentNode* left, * right;
+
+	// Shared for readers, exclusive for writers
+	shared_mutex lock;
+
+	// Parameterised ctor
+	ConcurrentNode(const Bid& bid) : data { bid }, left { nullptr }, right { nullptr } {}
+};
+
+/**
+ * A binary search tree that can be used from several threads at once.
+ * Every operation walks down with hand-over-hand (lock coupling) locking:
+ * a child is locked before its parent is released, so each operation
+ * only ever holds a short window of the path and they cannot overtake
+ * each other. Searches take shared locks and run side by side.
+ * Insert, Search and Remove are linearizable.
+ */
+class ConcurrentBinarySearchTree {
+
+private:
+	ConcurrentNode* root;
+
+	// Guards the root pointer (the root's 'parent' lock)
+	shared_mutex rootLock;
+
+	void Traverse(ConcurrentNode* node);
+	void DestroyRecursive(ConcurrentNode* node);
+
+public:
+	// Inlined default ctor
+	ConcurrentBinarySearchTree() { root = nullptr; }
+
+	// The locks cannot be copied
+	ConcurrentBinarySearchTree(const ConcurrentBinarySearchTree&) = delete;
+	ConcurrentBinarySearchTree& operator=(const ConcurrentBinarySearchTree&) = delete;
+
+	// destructor (not thread-safe: no other thread may be using the tree)
+	virtual ~ConcurrentBinarySearchTree() { DestroyRecursive(root); }
+
+	// Traverse the tree in order
+	void InOrder();
+
+	// Insert a node
+	void Insert(Bid bid);
+
+	// Delete a node
+	void Remove(string bidId);
+
+	// Search for a bid
+	Bid Search(string bidId);
+};
+
+//============================================================================
+// Persistent Binary Search Tree class definition
+//============================================================================
+
+/**
+ * Node struct for the persistent tree.
+ * Nodes are never changed once built, so versions can share them.
+ */
+struct PersistentNode {
+	// Shared, so that copying a node along a path does not copy the bid
+	shared_ptr<const Bid> data;
+
+	// Heap priority derived from the bidId (see PersistentBinarySearchTree)
+	size_t priority;
+
+	shared_ptr<const PersistentNode> left, right;
+
+	// Parameterised ctor
+	PersistentNode(shared_ptr<const Bid> bid, size_t prio,
+			shared_ptr<const PersistentNode> l, shared_ptr<const PersistentNode> r)
+		: data { move(bid) }, priority { prio }, left { move(l) }, right { move(r) } {}
+};
+
+/**
+ * An immutable (persistent) binary search tree.
+ * Insert and Remove leave this version untouched and return a new one
+ * that copies only the nodes on the path to the change and shares the rest.
+ * Nodes are reference counted, so a node is freed once no version uses it,
+ * and any version can be read from any number of threads without locks.
+ *
+ * The tree is kept as a treap: each node's priority is a hash of its bidId
+ * and parents outrank their children. The shape then does not depend on
+ * insertion order, so the paths stay O(log n) long even for sorted input.
+ */
+class PersistentBinarySearchTree {
+
+private:
+	typedef shared_ptr<const PersistentNode> NodePtr;
+
+	NodePtr root;
+	int size;
+
+	PersistentBinarySearchTree(NodePtr node, int count) : root { move(node) }, size { count } {}
+
+	static size_t Priority(const string& bidId);
+	static NodePtr AddNode(const NodePtr& node, const shared_ptr<const Bid>& bid, size_t prio, bool& added);
+	static NodePtr RemoveNode(const NodePtr& node, const string& bidId, bool& removed);
+	static NodePtr Merge(const NodePtr& low, const NodePtr& high);
+	static void Traverse(const PersistentNode* node);
+
+public:
+	// An empty version
+	PersistentBinarySearchTree() : size { 0 } {}
+
+	// A version holding bids already sorted by (unique) bidId, built in O(n)
+	static PersistentBinarySearchTree FromSorted(vector<Bid> sorted);
+
+	// Traverse this version in order
+	void InOrder() const { Traverse(root.get()); }
+
+	// A new version with the bid added
+	PersistentBinarySearchTree Insert(Bid bid) const;
+
+	// A new version without the bid
+	PersistentBinarySearchTree Remove(const string& bidId) const;
+
+	// Search this version for a bid
+	Bid Search(const string& bidId) const;
+
+	int Size() const { return size; }
+};
+
+//============================================================================
+// Lookup cache definition
+//============================================================================
+
+// Default number of bids the lookup cache holds
+const size_t DEFAULT_CACHE_CAPACITY = 1024;
+
+/**
+ * A bounded cache of bids by bidId, using the CLOCK approximation of LRU.
+ * Entries sit in a fixed ring of slots, each with a 'referenced' bit that
+ * a hit sets. To make room, a hand sweeps the ring clearing bits and
+ * evicts the first entry found without one, so recently used entries get
+ * a second chance. Unlike true LRU a hit does not reorder anything: it
+ * only sets an atomic flag, so hits need just a shared lock.
+ *
+ * The keys are split across independently locked shards, so threads
+ * looking up different bids rarely wait for each other. Each shard keeps
+ * an epoch that every Erase bumps; a Put made with an older epoch is
+ * dropped, so a lookup that raced with a Remove cannot cache a stale bid.
+ */
+class LookupCache {
+
+private:
+	struct Entry {
+		string key;
+		Bid bid;
+
+		// Set by hits, cleared by the sweeping hand
+		atomic<bool> referenced { false };
+
+		bool used = false;
+	};
+
+	struct Shard {
+		// Shared for hits, exclusive for changes
+		shared_mutex lock;
+
+		vector<Entry> entries;
+		unordered_map<string, size_t> slots;
+		size_t hand = 0;
+		uint64_t epoch = 0;
+
+		atomic<size_t> hits { 0 };
+		atomic<size_t> misses { 0 };
+		atomic<size_t> evictions { 0 };
+
+		explicit Shard(size_t capacity) : entries(capacity) {}
+	};
+
+	vector<unique_ptr<Shard>> shards;
+	size_t capacity;
+
+	Shard& ShardFor(const string& key);
+
+public:
+	// A cache of (at least) capacity bids split over shardCount shards
+	explicit LookupCache(size_t capacity = DEFAULT_CACHE_CAPACITY, unsigned shardCount = 1);
+
+	// Look up a bid; on a miss, epoch receives the value to pass to Put
+	bool Get(const string& key, Bid& bid, uint64_t& epoch);
+
+	// Cache a bid found after a miss that returned epoch
+	void Put(const string& key, const Bid& bid, uint64_t epoch);
+
+	// Drop any cached copy of a bid
+	void Erase(const string& key);
+
+	// Drop everything (the counters are kept)
+	void Clear();
+
+	size_t Hits() const;
+	size_t Misses() const;
+	size_t Evictions() const;
+	double HitRate() const;
+
+	size_t Capacity() const { return capacity; }
+	unsigned ShardCount() const { return shards.size(); }
+};
+
+/**
+ * Take a node for a bid, reusing a released node if there is one
+ *
+ * @param bid The bid to store in the node
+ */
+Node* NodePool::Acquire(const Bid& bid) {
+	Node* node;
+
+	// Recycle first
+	if (freeList) {
+		node = freeList;
+		freeList = node->left;
+	}
+	// Then carve from the current chunk, starting a new one when it runs out
+	else {
+		if (remaining == 0) {
+			next = new Node[CHUNK_SIZE];
+			chunks.push_back(next);
+			remaining = CHUNK_SIZE;
+		}
+		node = next++;
+		--remaining;
+	}
+
+	node->data = bid;
+	node->left = node->right = nullptr;
+	return node;
+}
+
+/**
+ * Take a contiguous block of empty nodes
+ *
+ * @param count Number of nodes in the block
+ */
+Node* NodePool::AcquireBlock(unsigned count) {
+	Node* block = new Node[count];
+	chunks.push_back(block);
+	return block;
+}
+
+/**
+ * Hand a node back to the pool for reuse.
+ * Its bid is cleared (moved out, not copied) and it joins the free list.
+ *
+ * @param node A node from this pool that is no longer linked into the tree
+ */
+void NodePool::Release(Node* node) {
+	node->data = Bid();
+	node->right = nullptr;
+	node->left = freeList;
+	freeList = node;
+}
+
+/**
+ * Free every chunk. All nodes from the pool become invalid.
+ */
+void NodePool::Clear() {
+	for (Node* chunk : chunks)
+		delete[] chunk;
+
+	chunks.clear();
+	next = freeList = nullptr;
+	remaining = 0;
+}
+
+/**
+ * Delete every node
+ */
+void BinarySearchTree::Clear() {
+	pool.Clear();
+	root = nullptr;
+	indexes.Clear();
+}
+
+/**
+ * Build a height-balanced tree from a vector of bids in O(n).
+ * The vector is sorted by bidId first if it is not already in order,
+ * and only the first of any duplicate IDs is kept (as with Insert).
+ * All nodes come from a single contiguous allocation laid out in order.
+ * The existing contents of the tree are discarded.
+ *
+ * @param bids The bids to build from. Their data is moved into the tree.
+ */
+void BinarySearchTree::BuildFromSorted(vector<Bid>& bids) {
+	// The tree is ordered on bidId alone
+	auto byId = [](const Bid& a, const Bid& b) { return a.bidId < b.bidId; };
+
+	// Sorted exports skip straight to the linear build
+	if (!is_sorted(bids.begin(), bids.end(), byId))
+		stable_sort(bids.begin(), bids.end(), byId);
+
+	// Keep the first occurrence of each ID
+	bids.erase(unique(bids.begin(), bids.end(),
+			[](const Bid& a, const Bid& b) { return a.bidId == b.bidId; }), bids.end());
+
+	Clear();
+
+	if (bids.empty())
+		return;
+
+	// Index the bids before they are moved into the nodes
+	for (const Bid& bid : bids)
+		indexes.Add(bid);
+
+	// One allocation for the whole tree
+	Node* block = pool.AcquireBlock(bids.size());
+
+	root = BuildBalanced(block, bids, 0, bids.size());
+}
+
+/**
+ * Private helper for BuildFromSorted (recursive)
+ * Links the nodes for bids[begin, end) around the middle element.
+ * Node i of the block holds bids[i], so the block is in sorted order.
+ */
+Node* BinarySearchTree::BuildBalanced(Node* block, vector<Bid>& bids, int begin, int end) {
+	if (begin >= end)
+		return nullptr;
+
+	int mid = begin + (end - begin) / 2;
+
+	Node* node = &block[mid];
+	node->data = move(bids[mid]);
+	node->left = BuildBalanced(block, bids, begin, mid);
+	node->right = BuildBalanced(block, bids, mid + 1, end);
+
+	return node;
+}
+
+/**
+ * Copy the current bids into a FrozenBidIndex.
+ * The index does not follow later changes to the tree.
+ */
+FrozenBidIndex BinarySearchTree::Freeze() {
+	// An in-order walk is already sorted by bidId
+	return FrozenBidIndex(Export());
+}
+
+/**
+ * Copy the current bids out, sorted by bidId
+ */
+vector<Bid> BinarySearchTree::Export() {
+	vector<Bid> bids;
+	CollectInOrder(root, bids);
+	return bids;
+}
+
+/**
+ * Private helper for Freeze (recursive)
  */
-void BinarySearchTree::DestroyRecursive(Node* node) {
+void BinarySearchTree::CollectInOrder(Node* node, vector<Bid>& bids) {
 	if (node) {
-		DestroyRecursive(node->left);
-		DestroyRecursive(node->right);
-		delete node;
+		CollectInOrder(node->left, bids);
+		bids.push_back(node->data);
+		CollectInOrder(node->right, bids);
+	}
+}
+
+/**
+ * Insert a bid. Duplicate IDs are ignored.
+ */
+void BinarySearchTree::Insert(Bid bid) {
+	// Only index bids that actually go in
+	if (SearchNode(root, bid.bidId) == nullptr)
+		indexes.Add(bid);
+
+	root = AddNode(root, bid);
+}
+
+/**
+ * Remove a bid
+ */
+void BinarySearchTree::Remove(const string& bidId) {
+	Node* node = SearchNode(root, bidId);
+	if (node == nullptr)
+		return;
+
+	// Unindex it as it was indexed, before the node goes
+	indexes.Remove(node->data);
+
+	root = RemoveNode(root, bidId);
+}
+
+/**
+ * Find the bids that match a query. An index narrows the candidates
+ * when the query has a fund, amount range or title prefix; otherwise
+ * every node is checked.
+ *
+ * @param query The query to answer
+ * @param plan Receives a description of how the query was answered
+ * @return The matching bids
+ */
+vector<Bid> BinarySearchTree::Query(const BidQuery& query, string* plan) {
+	vector<Bid> matches;
+	vector<string> bidIds;
+	string indexUsed;
+
+	if (indexes.Candidates(query, bidIds, indexUsed)) {
+		if (plan != nullptr)
+			*plan = indexUsed + " index, " + to_string(bidIds.size()) + " candidates";
+
+		// Ids are unique in the tree, so each candidate is one node
+		for (const string& bidId : bidIds) {
+			Node* node = SearchNode(root, bidId);
+			if (node != nullptr && query.Matches(node->data))
+				matches.push_back(node->data);
+		}
+		return matches;
+	}
+
+	if (plan != nullptr)
+		*plan = "full scan";
+
+	ScanNode(root, query, matches);
+	return matches;
+}
+
+/**
+ * Private helper for Query (recursive): check every node in order
+ */
+void BinarySearchTree::ScanNode(Node* node, const BidQuery& query, vector<Bid>& matches) {
+	if (node) {
+		ScanNode(node->left, query, matches);
+		if (query.Matches(node->data))
+			matches.push_back(node->data);
+		ScanNode(node->right, query, matches);
 	}
 }
 
@@ -134,10 +784,10 @@ Bid BinarySearchTree::Search(string bidId) {
  * @param node Current node in tree
  * @param bid Bid to be added
  */
-Node* BinarySearchTree::AddNode(Node* node, Bid bid) {
+Node* BinarySearchTree::AddNode(Node* node, const Bid& bid) {
 	// If the current node is null, add here
     if (!node) {
-    	return new Node(bid);
+    	return pool.Acquire(bid);
     }
     // If the bidId is less than the node's ID, move left
     else if (bid.bidId < node->data.bidId) {
@@ -186,8 +836,9 @@ Node* BinarySearchTree::SearchNode(Node* node, string bidId) {
 
 /**
  * Private helper function for node deletion (recursive)
+ * Nodes are only relinked; no bid data is copied.
  */
-Node* BinarySearchTree::RemoveNode(Node* node, string bidId) {
+Node* BinarySearchTree::RemoveNode(Node* node, const string& bidId) {
 	if (!node)
 		return node;
 
@@ -206,6 +857,7 @@ Node* BinarySearchTree::RemoveNode(Node* node, string bidId) {
 
 	// CASE 1: Deleting a leaf. Nothing much to do here...
 	if (!(node->left) && !(node->right)) {
+		pool.Release(node);
 		return nullptr;
 	}
 
@@ -215,7 +867,7 @@ Node* BinarySearchTree::RemoveNode(Node* node, string bidId) {
 		// Get the right child
 		Node* temp = node->right;
 		// Delete the parent
-		delete node;
+		pool.Release(node);
 		// Return the right child
 		return temp;
 	}
@@ -224,7 +876,7 @@ Node* BinarySearchTree::RemoveNode(Node* node, string bidId) {
 		// Get the left child
 		Node* temp = node->left;
 		// Delete the parent
-		delete node;
+		pool.Release(node);
 		// Return the left child
 		return temp;
 	}
@@ -246,35 +898,1203 @@ Node* BinarySearchTree::RemoveNode(Node* node, string bidId) {
 	/* Validity of this:
 	 * succ is always the left child of succParent
 	 * So succ->right can be made succParent->left
+	 * and succ takes over the node's right subtree.
+	 * (If succ is the node's right child, it keeps its own right subtree)
 	 */
 	if (succParent != node) {
 		succParent->left = succ->right;
-	}
-	/*
-	 * Make succ-right succParent->right
-	 */
-	else {
-		succParent->right = succ->right;
+		succ->right = node->right;
 	}
 
-	// Copy the successor's data to the node
-	node->data = succ->data;
+	// The successor takes over the node's left subtree
+	succ->left = node->left;
 
-	// delete the successor
-	delete succ;
+	// delete the node
+	pool.Release(node);
 
-	// return the node
-	return node;
+	// The successor takes the node's place
+	return succ;
 }
 
 //============================================================================
-// Static methods used for testing
+// Secondary index methods
 //============================================================================
 
 /**
- * Display the bid information to the console (std::out)
- *
- * @param bid struct containing the bid info
+ * Whether a bid satisfies every field of the query
+ */
+bool BidQuery::Matches(const Bid& bid) const {
+	return (fund.empty() || bid.fund == fund)
+			&& bid.title.compare(0, titlePrefix.size(), titlePrefix) == 0
+			&& (titleContains.empty() || bid.title.find(titleContains) != string::npos)
+			&& bid.amount >= minAmount && bid.amount <= maxAmount;
+}
+
+/**
+ * Index a bid
+ *
+ * @param bid The bid to index
+ */
+void BidIndexes::Add(const Bid& bid) {
+	byFund[bid.fund].insert(bid.bidId);
+	byAmount.emplace(bid.amount, bid.bidId);
+	byTitle.emplace(bid.title, bid.bidId);
+}
+
+/**
+ * Drop a bid from every index
+ *
+ * @param bid The bid as it was indexed
+ */
+void BidIndexes::Remove(const Bid& bid) {
+	auto fund = byFund.find(bid.fund);
+	if (fund != byFund.end()) {
+		unordered_set<string>& ids = fund->second;
+
+		ids.erase(bid.bidId);
+		if (ids.empty()) {
+			byFund.erase(fund);
+		}
+	}
+
+	auto amounts = byAmount.equal_range(bid.amount);
+	for (auto it = amounts.first; it != amounts.second; ++it) {
+		if (it->second == bid.bidId) {
+			byAmount.erase(it);
+			break;
+		}
+	}
+
+	auto titles = byTitle.equal_range(bid.title);
+	for (auto it = titles.first; it != titles.second; ++it) {
+		if (it->second == bid.bidId) {
+			byTitle.erase(it);
+			break;
+		}
+	}
+}
+
+/**
+ * Empty every index
+ */
+void BidIndexes::Clear() {
+	byFund.clear();
+	byAmount.clear();
+	byTitle.clear();
+}
+
+/**
+ * Candidate bidIds for a query from the most selective index that applies.
+ * A fund lookup is exact and counted in O(1); the ordered indexes are only
+ * counted up to the best count so far, so estimating never costs more than
+ * reading the winner. The caller still checks every field of each candidate.
+ *
+ * @param query The query to answer
+ * @param bidIds Receives the candidate ids
+ * @param indexUsed Receives the name of the index chosen
+ * @return false if no index applies and the caller has to scan
+ */
+bool BidIndexes::Candidates(const BidQuery& query, vector<string>& bidIds, string& indexUsed) const {
+	bool haveFund = !query.fund.empty();
+	bool haveAmount = query.minAmount > -HUGE_VAL || query.maxAmount < HUGE_VAL;
+	bool haveTitle = !query.titlePrefix.empty();
+
+	if (!haveFund && !haveAmount && !haveTitle) {
+		return false;
+	}
+
+	size_t best = SIZE_MAX;
+	auto fund = byFund.end();
+
+	if (haveFund) {
+		fund = byFund.find(query.fund);
+		best = (fund == byFund.end()) ? 0 : fund->second.size();
+		indexUsed = "fund";
+	}
+
+	auto amountBegin = byAmount.lower_bound(query.minAmount);
+	auto amountEnd = byAmount.upper_bound(query.maxAmount);
+	if (haveAmount && best > 0 && query.minAmount <= query.maxAmount) {
+		size_t count = 0;
+		for (auto it = amountBegin; it != amountEnd && count < best; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "amount";
+		}
+	}
+	else if (haveAmount && query.minAmount > query.maxAmount) {
+		// An empty range: nothing can match
+		best = 0;
+		indexUsed = "amount";
+		amountBegin = amountEnd = byAmount.end();
+	}
+
+	// Prefix matches run from the prefix up to the first title that doesn't start with it
+	auto titleBegin = byTitle.lower_bound(query.titlePrefix);
+	if (haveTitle && best > 0) {
+		size_t count = 0;
+		for (auto it = titleBegin; it != byTitle.end() && count < best
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "title";
+		}
+	}
+
+	bidIds.clear();
+	if (indexUsed == "fund") {
+		if (fund != byFund.end()) {
+			bidIds.assign(fund->second.begin(), fund->second.end());
+		}
+	}
+	else if (indexUsed == "amount") {
+		for (auto it = amountBegin; it != amountEnd; ++it) {
+			bidIds.push_back(it->second);
+		}
+	}
+	else {
+		for (auto it = titleBegin; it != byTitle.end()
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			bidIds.push_back(it->second);
+		}
+	}
+	return true;
+}
+
+//============================================================================
+// Concurrent Binary Search Tree methods
+//============================================================================
+
+/**
+ * Helper function for the destructor
+ */
+void ConcurrentBinarySearchTree::DestroyRecursive(ConcurrentNode* node) {
+	if (node) {
+		DestroyRecursive(node->left);
+		DestroyRecursive(node->right);
+		delete node;
+	}
+}
+
+/**
+ * Traverse the tree in order.
+ * Writers wait while the traversal holds the locks on its current path.
+ */
+void ConcurrentBinarySearchTree::InOrder() {
+	shared_lock<shared_mutex> lock(rootLock);
+	Traverse(root);
+}
+
+/**
+ * Private helper function for tree traversal (recursive)
+ * The caller holds the lock of the node's parent.
+ */
+void ConcurrentBinarySearchTree::Traverse(ConcurrentNode* node) {
+	if (node) {
+		shared_lock<shared_mutex> lock(node->lock);
+
+		Traverse(node->left);
+		cout << node->data;
+		Traverse(node->right);
+	}
+}
+
+/**
+ * Search for a bid
+ *
+ * @param bidId The bid id to search for
+ */
+Bid ConcurrentBinarySearchTree::Search(string bidId) {
+	Bid bid;
+
+	shared_lock<shared_mutex> parentLock(rootLock);
+	ConcurrentNode* node = root;
+
+	while (node) {
+		// Lock the node, then let go of its parent
+		shared_lock<shared_mutex> nodeLock(node->lock);
+		parentLock = move(nodeLock);
+
+		// Found: copy it out while it is still locked
+		if (bidId == node->data.bidId) {
+			bid = node->data;
+			break;
+		}
+
+		node = (bidId < node->data.bidId) ? node->left : node->right;
+	}
+
+	return bid;
+}
+
+/**
+ * Insert a bid. Duplicate IDs are ignored, as in BinarySearchTree.
+ *
+ * @param bid The bid to insert
+ */
+void ConcurrentBinarySearchTree::Insert(Bid bid) {
+	// Allocate before taking any locks
+	ConcurrentNode* newNode = new ConcurrentNode(bid);
+
+	// link is the pointer to update; parentLock is the lock that guards it
+	unique_lock<shared_mutex> parentLock(rootLock);
+	ConcurrentNode** link = &root;
+
+	while (*link) {
+		ConcurrentNode* node = *link;
+
+		unique_lock<shared_mutex> nodeLock(node->lock);
+		parentLock = move(nodeLock);
+
+		if (bid.bidId < node->data.bidId) {
+			link = &node->left;
+		}
+		else if (bid.bidId > node->data.bidId) {
+			link = &node->right;
+		}
+		// Already present
+		else {
+			delete newNode;
+			return;
+		}
+	}
+
+	*link = newNode;
+}
+
+/**
+ * Remove a bid
+ * Nodes are relinked rather than copied, so a reader holding a node
+ * never sees its data change underneath it.
+ *
+ * @param bidId The bid id to remove
+ */
+void ConcurrentBinarySearchTree::Remove(string bidId) {
+	// Find the node while holding the lock that guards the link to it
+	unique_lock<shared_mutex> parentLock(rootLock);
+	unique_lock<shared_mutex> nodeLock;
+	ConcurrentNode** link = &root;
+	ConcurrentNode* node;
+
+	while (true) {
+		node = *link;
+
+		// Not found
+		if (!node)
+			return;
+
+		unique_lock<shared_mutex> lock(node->lock);
+
+		// Keep both the parent and the node locked
+		if (bidId == node->data.bidId) {
+			nodeLock = move(lock);
+			break;
+		}
+
+		parentLock = move(lock);
+		link = (bidId < node->data.bidId) ? &node->left : &node->right;
+	}
+
+	// CASE 1 & 2: At most one child, which takes the node's place
+	if (!(node->left) || !(node->right)) {
+		*link = node->left ? node->left : node->right;
+	}
+
+	// CASE 3: Two children. The successor (leftmost on the right) takes its place
+	else {
+		ConcurrentNode* succParent = node;
+		ConcurrentNode* succ = node->right;
+
+		// Empty until succParent moves below the node (which is already locked)
+		unique_lock<shared_mutex> succParentLock;
+		unique_lock<shared_mutex> succLock(succ->lock);
+
+		while (succ->left) {
+			ConcurrentNode* next = succ->left;
+			unique_lock<shared_mutex> nextLock(next->lock);
+
+			succParentLock = move(succLock);
+			succLock = move(nextLock);
+			succParent = succ;
+			succ = next;
+		}
+
+		// Detach the successor, then hand it the node's children
+		if (succParent != node) {
+			succParent->left = succ->right;
+			succ->right = node->right;
+		}
+		succ->left = node->left;
+
+		*link = succ;
+	}
+
+	/* Safe to free: reaching the node means locking its parent first,
+	 * and the parent has been held since before the node was locked
+	 */
+	nodeLock.unlock();
+	delete node;
+}
+
+//============================================================================
+// Persistent Binary Search Tree methods
+//============================================================================
+
+/**
+ * Treap priority for a bidId.
+ * The hash is mixed again so that the priorities look random
+ * even where the standard library hash is weak.
+ */
+size_t PersistentBinarySearchTree::Priority(const string& bidId) {
+	uint64_t x = hash<string>()(bidId);
+
+	// splitmix64 finaliser
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+
+	return x;
+}
+
+/**
+ * Build a version from sorted bids in one pass, without the per-bid
+ * path copying of Insert. The stack holds the right spine of the treap
+ * built so far; each new (largest) bid pops the spine nodes it outranks,
+ * adopts the last one popped as its left child and becomes the right
+ * child of the node left on top.
+ *
+ * @param sorted Bids sorted by bidId with no duplicate IDs. Moved from.
+ */
+PersistentBinarySearchTree PersistentBinarySearchTree::FromSorted(vector<Bid> sorted) {
+	// The nodes are only linked up here, before anything else can see them
+	vector<shared_ptr<PersistentNode>> spine;
+
+	for (Bid& bid : sorted) {
+		size_t prio = Priority(bid.bidId);
+		shared_ptr<PersistentNode> node = make_shared<PersistentNode>(
+				make_shared<const Bid>(move(bid)), prio, nullptr, nullptr);
+
+		shared_ptr<PersistentNode> popped;
+		while (!spine.empty() && spine.back()->priority < prio) {
+			popped = move(spine.back());
+			spine.pop_back();
+		}
+
+		node->left = popped;
+		if (!spine.empty())
+			spine.back()->right = node;
+		spine.push_back(move(node));
+	}
+
+	return PersistentBinarySearchTree(spine.empty() ? nullptr : spine.front(), sorted.size());
+}
+
+/**
+ * Insert a bid. Duplicate IDs are ignored, as in BinarySearchTree.
+ *
+ * @param bid The bid to insert
+ * @return The new version (this version if the ID was already present)
+ */
+PersistentBinarySearchTree PersistentBinarySearchTree::Insert(Bid bid) const {
+	bool added = false;
+	size_t prio = Priority(bid.bidId);
+
+	NodePtr newRoot = AddNode(root, make_shared<const Bid>(move(bid)), prio, added);
+
+	return PersistentBinarySearchTree(newRoot, added ? size + 1 : size);
+}
+
+/**
+ * Private helper for Insert (recursive)
+ * Copies the nodes on the path and rotates the new node up past
+ * any ancestors with a lower priority.
+ *
+ * @param added Set when the bid was not already present
+ */
+PersistentBinarySearchTree::NodePtr PersistentBinarySearchTree::AddNode(const NodePtr& node,
+		const shared_ptr<const Bid>& bid, size_t prio, bool& added) {
+	// Empty spot: the new leaf
+	if (!node) {
+		added = true;
+		return make_shared<const PersistentNode>(bid, prio, nullptr, nullptr);
+	}
+
+	if (bid->bidId < node->data->bidId) {
+		NodePtr left = AddNode(node->left, bid, prio, added);
+
+		// Nothing changed below, so share this whole subtree
+		if (!added)
+			return node;
+
+		// Rotate right if the new child outranks this node
+		if (left->priority > node->priority) {
+			NodePtr demoted = make_shared<const PersistentNode>(node->data, node->priority, left->right, node->right);
+			return make_shared<const PersistentNode>(left->data, left->priority, left->left, demoted);
+		}
+
+		return make_shared<const PersistentNode>(node->data, node->priority, left, node->right);
+	}
+	else if (bid->bidId > node->data->bidId) {
+		NodePtr right = AddNode(node->right, bid, prio, added);
+
+		if (!added)
+			return node;
+
+		// Rotate left if the new child outranks this node
+		if (right->priority > node->priority) {
+			NodePtr demoted = make_shared<const PersistentNode>(node->data, node->priority, node->left, right->left);
+			return make_shared<const PersistentNode>(right->data, right->priority, demoted, right->right);
+		}
+
+		return make_shared<const PersistentNode>(node->data, node->priority, node->left, right);
+	}
+
+	// Already present
+	return node;
+}
+
+/**
+ * Remove a bid
+ *
+ * @param bidId The bid id to remove
+ * @return The new version (this version if the ID was not present)
+ */
+PersistentBinarySearchTree PersistentBinarySearchTree::Remove(const string& bidId) const {
+	bool removed = false;
+
+	NodePtr newRoot = RemoveNode(root, bidId, removed);
+
+	return PersistentBinarySearchTree(newRoot, removed ? size - 1 : size);
+}
+
+/**
+ * Private helper for Remove (recursive)
+ *
+ * @param removed Set when the bid was found
+ */
+PersistentBinarySearchTree::NodePtr PersistentBinarySearchTree::RemoveNode(const NodePtr& node,
+		const string& bidId, bool& removed) {
+	// Not found: nothing to copy
+	if (!node)
+		return node;
+
+	if (bidId < node->data->bidId) {
+		NodePtr left = RemoveNode(node->left, bidId, removed);
+		return removed ? make_shared<const PersistentNode>(node->data, node->priority, left, node->right) : node;
+	}
+	else if (bidId > node->data->bidId) {
+		NodePtr right = RemoveNode(node->right, bidId, removed);
+		return removed ? make_shared<const PersistentNode>(node->data, node->priority, node->left, right) : node;
+	}
+
+	// Found: its two subtrees take its place
+	removed = true;
+	return Merge(node->left, node->right);
+}
+
+/**
+ * Merge two treaps where every key in low is less than every key in high.
+ * Only the nodes along the right spine of low and the left spine of high are copied.
+ */
+PersistentBinarySearchTree::NodePtr PersistentBinarySearchTree::Merge(const NodePtr& low, const NodePtr& high) {
+	if (!low)
+		return high;
+	if (!high)
+		return low;
+
+	// The higher priority becomes the root
+	if (low->priority > high->priority)
+		return make_shared<const PersistentNode>(low->data, low->priority, low->left, Merge(low->right, high));
+
+	return make_shared<const PersistentNode>(high->data, high->priority, Merge(low, high->left), high->right);
+}
+
+/**
+ * Search this version for a bid
+ *
+ * @param bidId The bid id to search for
+ */
+Bid PersistentBinarySearchTree::Search(const string& bidId) const {
+	const PersistentNode* node = root.get();
+
+	while (node) {
+		if (bidId == node->data->bidId)
+			return *(node->data);
+
+		node = (bidId < node->data->bidId) ? node->left.get() : node->right.get();
+	}
+
+	return Bid();
+}
+
+/**
+ * Private helper function for tree traversal (recursive)
+ */
+void PersistentBinarySearchTree::Traverse(const PersistentNode* node) {
+	if (node) {
+		Traverse(node->left.get());
+		cout << *(node->data);
+		Traverse(node->right.get());
+	}
+}
+
+//============================================================================
+// Frozen search index methods
+//============================================================================
+
+/**
+ * Build the Eytzinger layout over a sorted vector of bids
+ *
+ * @param sorted Bids sorted by bidId
+ */
+FrozenBidIndex::FrozenBidIndex(vector<Bid> sorted) : payload { move(sorted) } {
+	keys.resize(payload.size() + 1);
+	rank.resize(payload.size() + 1);
+
+	Layout(0, 1);
+}
+
+/**
+ * Pack the first 8 characters of a bidId into an integer.
+ * Big-endian packing keeps the string order: if a < b then PackKey(a) <= PackKey(b).
+ * Ties (IDs sharing a prefix) are settled against the payload.
+ */
+uint64_t FrozenBidIndex::PackKey(const string& bidId) {
+	uint64_t key = 0;
+
+	for (unsigned i = 0; i < 8; ++i) {
+		key <<= 8;
+		if (i < bidId.size())
+			key |= (unsigned char) bidId[i];
+	}
+
+	return key;
+}
+
+/**
+ * Private helper for the ctor (recursive)
+ * An in-order walk of the implicit tree visits the sorted bids in order.
+ *
+ * @param sortedIdx Next position in the payload to place
+ * @param k Current slot in the implicit tree
+ * @return The next position in the payload after this subtree
+ */
+int FrozenBidIndex::Layout(int sortedIdx, unsigned k) {
+	if (k < keys.size()) {
+		sortedIdx = Layout(sortedIdx, 2 * k);
+
+		keys[k] = PackKey(payload[sortedIdx].bidId);
+		rank[k] = sortedIdx++;
+
+		sortedIdx = Layout(sortedIdx, 2 * k + 1);
+	}
+	return sortedIdx;
+}
+
+/**
+ * Search for a bid
+ *
+ * @param bidId The bid id to search for
+ * @return The bid, or nullptr if not found
+ */
+const Bid* FrozenBidIndex::Find(const string& bidId) const {
+	const uint64_t key = PackKey(bidId);
+	const size_t n = payload.size();
+
+	// Descend without branching on the comparison: go right when keys[k] < key
+	size_t k = 1;
+	while (k <= n) {
+#if defined(__GNUC__)
+		// Bring in the line holding the descendants three levels down
+		__builtin_prefetch(keys.data() + k * 8);
+#endif
+		k = 2 * k + (keys[k] < key);
+	}
+
+	// Undo the right turns taken after the last left turn.
+	// That left turn was at the first key >= the search key (lower bound).
+	while (k & 1)
+		k >>= 1;
+	k >>= 1;
+
+	// Every key was smaller
+	if (k == 0)
+		return nullptr;
+
+	// Check the run of IDs that share the packed prefix
+	for (size_t i = rank[k]; i < n; ++i) {
+		int cmp = payload[i].bidId.compare(bidId);
+		if (cmp == 0)
+			return &payload[i];
+		if (cmp > 0)
+			break;
+	}
+
+	return nullptr;
+}
+
+//============================================================================
+// Inverted title index methods
+//============================================================================
+
+/**
+ * Split text into terms: runs of letters and digits, lower-cased
+ *
+ * @param text The text to split
+ * @return The terms, in order (repeats kept)
+ */
+vector<string> TitleIndex::Tokenize(const string& text) {
+	vector<string> tokens;
+	string token;
+
+	for (char c : text) {
+		if (isalnum((unsigned char) c)) {
+			token += (char) tolower((unsigned char) c);
+		}
+		else if (!token.empty()) {
+			tokens.push_back(token);
+			token.clear();
+		}
+	}
+	if (!token.empty()) {
+		tokens.push_back(token);
+	}
+
+	return tokens;
+}
+
+/**
+ * Add a document to the end of a posting list
+ * Documents arrive in ascending order, so only the gap is stored,
+ * 7 bits per byte with the high bit marking that more bytes follow.
+ */
+void TitleIndex::Append(PostingList& list, uint32_t doc) {
+	// A title may repeat a term
+	if (list.count > 0 && doc == list.last) {
+		return;
+	}
+
+	uint32_t gap = (list.count == 0) ? doc : doc - list.last;
+	while (gap >= 0x80) {
+		list.bytes.push_back((uint8_t) (gap | 0x80));
+		gap >>= 7;
+	}
+	list.bytes.push_back((uint8_t) gap);
+
+	list.last = doc;
+	++list.count;
+}
+
+/**
+ * Expand a posting list back into document numbers
+ */
+vector<uint32_t> TitleIndex::Decode(const PostingList& list) {
+	vector<uint32_t> out;
+	out.reserve(list.count);
+
+	uint32_t doc = 0;
+	size_t i = 0;
+	while (i < list.bytes.size()) {
+		uint32_t gap = 0;
+		unsigned shift = 0;
+		uint8_t byte;
+		do {
+			byte = list.bytes[i++];
+			gap |= (uint32_t) (byte & 0x7F) << shift;
+			shift += 7;
+		} while (byte & 0x80);
+
+		doc += gap;
+		out.push_back(doc);
+	}
+
+	return out;
+}
+
+/**
+ * Documents containing every term of a query word,
+ * with a trailing * making the last term a prefix
+ */
+vector<uint32_t> TitleIndex::TermDocs(const string& word) const {
+	bool prefix = !word.empty() && word.back() == '*';
+	vector<string> tokens = Tokenize(word);
+
+	vector<uint32_t> result;
+	for (unsigned t = 0; t < tokens.size(); ++t) {
+		vector<uint32_t> matches;
+
+		if (prefix && t + 1 == tokens.size()) {
+			// Every term from the prefix up to the first that doesn't start with it;
+			// uniting them pairwise would re-copy the growing result once per term,
+			// so mark each term's documents in a bitmap and collect them once
+			auto first = terms.lower_bound(tokens[t]);
+			auto last = first;
+			while (last != terms.end() && last->first.compare(0, tokens[t].size(), tokens[t]) == 0) {
+				++last;
+			}
+
+			if (first != last && next(first) == last) {
+				matches = Decode(first->second);
+			}
+			else if (first != last) {
+				vector<bool> hit(bidIds.size(), false);
+				for (auto it = first; it != last; ++it) {
+					for (uint32_t doc : Decode(it->second)) {
+						hit[doc] = true;
+					}
+				}
+				for (uint32_t doc = 0; doc < hit.size(); ++doc) {
+					if (hit[doc]) {
+						matches.push_back(doc);
+					}
+				}
+			}
+		}
+		else {
+			auto it = terms.find(tokens[t]);
+			if (it != terms.end()) {
+				matches = Decode(it->second);
+			}
+		}
+
+		result = (t == 0) ? move(matches) : Intersect(result, matches);
+		if (result.empty()) {
+			break;
+		}
+	}
+
+	return result;
+}
+
+/**
+ * Documents in both ascending lists
+ * Lists of very different lengths: binary search the short one's
+ * documents in the long one. Otherwise walk both four at a time, with
+ * SSE2 comparing a block of one against every rotation of a block of
+ * the other, then finish with a plain merge.
+ */
+vector<uint32_t> TitleIndex::Intersect(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	const vector<uint32_t>& small = (a.size() <= b.size()) ? a : b;
+	const vector<uint32_t>& large = (a.size() <= b.size()) ? b : a;
+
+	vector<uint32_t> out;
+	out.reserve(small.size());
+
+	if (small.size() * 32 < large.size()) {
+		auto from = large.begin();
+		for (uint32_t doc : small) {
+			from = lower_bound(from, large.end(), doc);
+			if (from == large.end())
+				break;
+			if (*from == doc)
+				out.push_back(doc);
+		}
+		return out;
+	}
+
+	size_t i = 0, j = 0;
+
+#if defined(__SSE2__)
+	while (i + 4 <= small.size() && j + 4 <= large.size()) {
+		__m128i x = _mm_loadu_si128((const __m128i*) (small.data() + i));
+		__m128i y = _mm_loadu_si128((const __m128i*) (large.data() + j));
+
+		__m128i eq = _mm_or_si128(
+				_mm_or_si128(_mm_cmpeq_epi32(x, y),
+						_mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(0, 3, 2, 1)))),
+				_mm_or_si128(_mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(1, 0, 3, 2))),
+						_mm_cmpeq_epi32(x, _mm_shuffle_epi32(y, _MM_SHUFFLE(2, 1, 0, 3)))));
+
+		int mask = _mm_movemask_ps(_mm_castsi128_ps(eq));
+		for (int lane = 0; lane < 4; ++lane) {
+			if (mask & (1 << lane))
+				out.push_back(small[i + lane]);
+		}
+
+		// Move past whichever block ends lower (both if they end together)
+		uint32_t smallMax = small[i + 3];
+		uint32_t largeMax = large[j + 3];
+		if (smallMax <= largeMax)
+			i += 4;
+		if (largeMax <= smallMax)
+			j += 4;
+	}
+#endif
+
+	while (i < small.size() && j < large.size()) {
+		if (small[i] < large[j]) {
+			++i;
+		}
+		else if (large[j] < small[i]) {
+			++j;
+		}
+		else {
+			out.push_back(small[i]);
+			++i;
+			++j;
+		}
+	}
+
+	return out;
+}
+
+/**
+ * Documents in either ascending list
+ */
+vector<uint32_t> TitleIndex::Unite(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+	vector<uint32_t> out;
+	out.reserve(a.size() + b.size());
+	set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(out));
+	return out;
+}
+
+/**
+ * Index a bid's title
+ * Like the tree, the first bid with a given id wins; a later one is ignored
+ *
+ * @param bid The bid to index
+ */
+void TitleIndex::Add(const Bid& bid) {
+	if (docs.count(bid.bidId)) {
+		return;
+	}
+
+	uint32_t doc = bidIds.size();
+	bidIds.push_back(bid.bidId);
+	removed.push_back(false);
+	docs[bid.bidId] = doc;
+
+	for (const string& token : Tokenize(bid.title)) {
+		Append(terms[token], doc);
+	}
+}
+
+/**
+ * Stop returning a bid from searches
+ *
+ * @param bidId The bid id to drop
+ */
+void TitleIndex::Remove(const string& bidId) {
+	auto found = docs.find(bidId);
+	if (found != docs.end()) {
+		removed[found->second] = true;
+		docs.erase(found);
+	}
+}
+
+/**
+ * Empty the index
+ */
+void TitleIndex::Clear() {
+	terms.clear();
+	bidIds.clear();
+	removed.clear();
+	docs.clear();
+}
+
+/**
+ * Search the titles
+ * Words are ANDed; "OR" between two words unites them, so
+ * "dell OR hp laptop" finds (dell or hp) and laptop. A word ending in *
+ * matches terms starting with it.
+ *
+ * @param query The query text
+ * @return Ids of the matching bids, in the order they were added
+ */
+vector<string> TitleIndex::Search(const string& query) const {
+	istringstream words(query);
+	string word;
+	vector<vector<uint32_t>> clauses;
+	bool orNext = false;
+
+	while (words >> word) {
+		if (word == "OR") {
+			orNext = !clauses.empty();
+			continue;
+		}
+
+		vector<uint32_t> matches = TermDocs(word);
+		if (orNext) {
+			clauses.back() = Unite(clauses.back(), matches);
+			orNext = false;
+		}
+		else {
+			clauses.push_back(move(matches));
+		}
+	}
+
+	vector<string> results;
+	if (clauses.empty()) {
+		return results;
+	}
+
+	// Intersect the shortest lists first so the running result stays small
+	sort(clauses.begin(), clauses.end(), [](const vector<uint32_t>& a, const vector<uint32_t>& b) {
+		return a.size() < b.size();
+	});
+
+	vector<uint32_t> matched = clauses[0];
+	for (unsigned c = 1; c < clauses.size() && !matched.empty(); ++c) {
+		matched = Intersect(matched, clauses[c]);
+	}
+
+	for (uint32_t doc : matched) {
+		if (!removed[doc]) {
+			results.push_back(bidIds[doc]);
+		}
+	}
+	return results;
+}
+
+/**
+ * Bytes used by the compressed posting lists
+ */
+size_t TitleIndex::PostingBytes() const {
+	size_t bytes = 0;
+	for (const auto& term : terms) {
+		bytes += term.second.bytes.size();
+	}
+	return bytes;
+}
+
+//============================================================================
+// Lookup cache methods
+//============================================================================
+
+/**
+ * Constructor. The capacity is spread evenly over the shards.
+ *
+ * @param capacity Number of bids to hold
+ * @param shardCount Number of independently locked shards (1 for one thread)
+ */
+LookupCache::LookupCache(size_t capacity, unsigned shardCount) {
+	shardCount = max(shardCount, 1u);
+	size_t perShard = max<size_t>((capacity + shardCount - 1) / shardCount, 1);
+
+	for (unsigned s = 0; s < shardCount; ++s) {
+		shards.emplace_back(new Shard(perShard));
+	}
+	this->capacity = perShard * shardCount;
+}
+
+/**
+ * The shard a key belongs to
+ */
+LookupCache::Shard& LookupCache::ShardFor(const string& key) {
+	return *shards[hash<string>()(key) % shards.size()];
+}
+
+/**
+ * Look up a bid. A hit only marks the entry as referenced.
+ *
+ * @param key The bidId
+ * @param bid Receives the cached bid on a hit
+ * @param epoch Receives the shard's epoch on a miss
+ * @return true on a hit
+ */
+bool LookupCache::Get(const string& key, Bid& bid, uint64_t& epoch) {
+	Shard& shard = ShardFor(key);
+	shared_lock<shared_mutex> lock(shard.lock);
+
+	auto found = shard.slots.find(key);
+	if (found == shard.slots.end()) {
+		epoch = shard.epoch;
+		shard.misses.fetch_add(1, memory_order_relaxed);
+		return false;
+	}
+
+	Entry& entry = shard.entries[found->second];
+	entry.referenced.store(true, memory_order_relaxed);
+	bid = entry.bid;
+	shard.hits.fetch_add(1, memory_order_relaxed);
+	return true;
+}
+
+/**
+ * Cache a bid, evicting the first unreferenced entry under the hand if
+ * the shard is full. Dropped if the key's shard has seen an Erase since
+ * the miss, as the bid may already be out of date.
+ *
+ * @param key The bidId
+ * @param bid The bid read from the container
+ * @param epoch The epoch returned by the missing Get
+ */
+void LookupCache::Put(const string& key, const Bid& bid, uint64_t epoch) {
+	Shard& shard = ShardFor(key);
+	unique_lock<shared_mutex> lock(shard.lock);
+
+	if (shard.epoch != epoch) {
+		return;
+	}
+
+	// Another thread missed on the same key and got here first
+	auto found = shard.slots.find(key);
+	if (found != shard.slots.end()) {
+		shard.entries[found->second].bid = bid;
+		return;
+	}
+
+	// Sweep: referenced entries get a second chance, the first other one goes
+	size_t ringSize = shard.entries.size();
+	while (shard.entries[shard.hand].used) {
+		Entry& entry = shard.entries[shard.hand];
+		if (!entry.referenced.exchange(false, memory_order_relaxed)) {
+			shard.slots.erase(entry.key);
+			entry.used = false;
+			shard.evictions.fetch_add(1, memory_order_relaxed);
+			break;
+		}
+		shard.hand = (shard.hand + 1) % ringSize;
+	}
+
+	// New entries start unreferenced, so one-off lookups are evicted first
+	Entry& entry = shard.entries[shard.hand];
+	entry.key = key;
+	entry.bid = bid;
+	entry.referenced.store(false, memory_order_relaxed);
+	entry.used = true;
+	shard.slots[key] = shard.hand;
+	shard.hand = (shard.hand + 1) % ringSize;
+}
+
+/**
+ * Drop any cached copy of a bid and start a new epoch for its shard
+ *
+ * @param key The bidId
+ */
+void LookupCache::Erase(const string& key) {
+	Shard& shard = ShardFor(key);
+	unique_lock<shared_mutex> lock(shard.lock);
+
+	++shard.epoch;
+
+	auto found = shard.slots.find(key);
+	if (found != shard.slots.end()) {
+		Entry& entry = shard.entries[found->second];
+		entry.key.clear();
+		entry.bid = Bid();
+		entry.used = false;
+		shard.slots.erase(found);
+	}
+}
+
+/**
+ * Drop every cached bid
+ */
+void LookupCache::Clear() {
+	for (auto& shard : shards) {
+		unique_lock<shared_mutex> lock(shard->lock);
+
+		++shard->epoch;
+		for (Entry& entry : shard->entries) {
+			entry.key.clear();
+			entry.bid = Bid();
+			entry.referenced.store(false, memory_order_relaxed);
+			entry.used = false;
+		}
+		shard->slots.clear();
+		shard->hand = 0;
+	}
+}
+
+size_t LookupCache::Hits() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->hits.load(memory_order_relaxed);
+	}
+	return total;
+}
+
+size_t LookupCache::Misses() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->misses.load(memory_order_relaxed);
+	}
+	return total;
+}
+
+size_t LookupCache::Evictions() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->evictions.load(memory_order_relaxed);
+	}
+	return total;
+}
+
+/**
+ * Share of lookups answered from the cache
+ */
+double LookupCache::HitRate() const {
+	size_t hits = Hits();
+	size_t lookups = hits + Misses();
+	return lookups == 0 ? 0.0 : hits * 1.0 / lookups;
+}
+
+/**
+ * A container with a lookup cache in front of its searches.
+ * Works with any container offering Insert(Bid), Remove(string) and
+ * Search(string) returning an empty Bid when not found, such as
+ * BinarySearchTree or ConcurrentBinarySearchTree. Only bids that were
+ * found are cached. Insert and Remove go to the container first and then
+ * invalidate the cached copy. With a thread-safe container and more than
+ * one shard, any number of threads can search and change it at once.
+ */
+template <typename Container>
+class CachedContainer {
+
+private:
+	Container* container;
+	LookupCache cache;
+
+public:
+	CachedContainer(Container* container, size_t capacity = DEFAULT_CACHE_CAPACITY, unsigned shardCount = 1)
+			: container { container }, cache { capacity, shardCount } {}
+
+	void Insert(Bid bid) {
+		string bidId = bid.bidId;
+		container->Insert(bid);
+		cache.Erase(bidId);
+	}
+
+	void Remove(string bidId) {
+		container->Remove(bidId);
+		cache.Erase(bidId);
+	}
+
+	Bid Search(string bidId) {
+		Bid bid;
+		uint64_t epoch;
+		if (cache.Get(bidId, bid, epoch)) {
+			return bid;
+		}
+
+		bid = container->Search(bidId);
+		if (!bid.bidId.empty()) {
+			cache.Put(bidId, bid, epoch);
+		}
+		return bid;
+	}
+
+	// Forget every cached bid, e.g. after the container is reloaded
+	void Invalidate() { cache.Clear(); }
+
+	const LookupCache& Cache() const { return cache; }
+};
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+ * Display the bid information to the console (std::out)
+ *
+ * @param bid struct containing the bid info
  */
 void displayBid(Bid bid) {
     cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
@@ -282,13 +2102,280 @@ void displayBid(Bid bid) {
     return;
 }
 
+/**
+ * Time lookups of every bid (plus as many misses) through the tree,
+ * std::lower_bound over the sorted bids and the frozen index
+ *
+ * @param bst The tree to search
+ * @param frozen A frozen copy of the same tree
+ */
+void benchmarkSearch(BinarySearchTree* bst, const FrozenBidIndex& frozen) {
+	const vector<Bid>& sorted = frozen.Sorted();
+	const int rounds = 20;
+
+	// Half hits, half misses, in random order
+	vector<string> queries;
+	for (const Bid& bid : sorted) {
+		queries.push_back(bid.bidId);
+		queries.push_back(bid.bidId + "x");
+	}
+	shuffle(queries.begin(), queries.end(), mt19937(42));
+
+	clock_t ticks;
+	long found;
+
+	// The pointer-based tree
+	ticks = clock();
+	found = 0;
+	for (int r = 0; r < rounds; ++r)
+		for (const string& q : queries)
+			found += bst->Find(q) != nullptr;
+	ticks = clock() - ticks;
+	cout << "tree:        " << found << " found, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+	// Binary search over the sorted array
+	ticks = clock();
+	found = 0;
+	for (int r = 0; r < rounds; ++r)
+		for (const string& q : queries) {
+			auto it = lower_bound(sorted.begin(), sorted.end(), q,
+					[](const Bid& bid, const string& id) { return bid.bidId < id; });
+			found += it != sorted.end() && it->bidId == q;
+		}
+	ticks = clock() - ticks;
+	cout << "lower_bound: " << found << " found, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+	// The Eytzinger layout
+	ticks = clock();
+	found = 0;
+	for (int r = 0; r < rounds; ++r)
+		for (const string& q : queries)
+			found += frozen.Find(q) != nullptr;
+	ticks = clock() - ticks;
+	cout << "frozen:      " << found << " found, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+}
+
+/**
+ * Private helper for benchmarkConcurrentSearch (recursive)
+ * Inserts the middle bid first so that sorted input gives a balanced tree.
+ */
+void insertBalanced(ConcurrentBinarySearchTree& tree, const vector<Bid>& sorted, int begin, int end) {
+	if (begin < end) {
+		int mid = begin + (end - begin) / 2;
+		tree.Insert(sorted[mid]);
+		insertBalanced(tree, sorted, begin, mid);
+		insertBalanced(tree, sorted, mid + 1, end);
+	}
+}
+
+/**
+ * Time concurrent searches of the concurrent tree on 1 to N reader threads,
+ * with and without a writer thread removing and re-inserting bids
+ *
+ * @param frozen A frozen copy of the bids to load into the tree
+ */
+void benchmarkConcurrentSearch(const FrozenBidIndex& frozen) {
+	const vector<Bid>& sorted = frozen.Sorted();
+	if (sorted.empty())
+		return;
+
+	ConcurrentBinarySearchTree tree;
+	insertBalanced(tree, sorted, 0, sorted.size());
+
+	const int searchesPerThread = 200000;
+	unsigned maxThreads = max(4u, thread::hardware_concurrency());
+
+	for (int withWriter = 0; withWriter < 2; ++withWriter) {
+		cout << (withWriter ? "with a writer:" : "readers only:") << endl;
+
+		for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+			atomic<bool> done { false };
+			vector<thread> readers;
+
+			// Wall-clock time: clock() would add up every thread's CPU time
+			auto start = chrono::steady_clock::now();
+
+			for (unsigned t = 0; t < threads; ++t) {
+				readers.emplace_back([&, t]() {
+					mt19937 rng(t);
+					for (int i = 0; i < searchesPerThread; ++i)
+						tree.Search(sorted[rng() % sorted.size()].bidId);
+				});
+			}
+
+			// Churn the tree until the readers finish
+			thread writer;
+			if (withWriter) {
+				writer = thread([&]() {
+					mt19937 rng(1234);
+					while (!done) {
+						const Bid& bid = sorted[rng() % sorted.size()];
+						tree.Remove(bid.bidId);
+						tree.Insert(bid);
+					}
+				});
+			}
+
+			for (thread& reader : readers)
+				reader.join();
+			done = true;
+			if (writer.joinable())
+				writer.join();
+
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			cout << "  " << threads << " threads: " << threads * searchesPerThread / seconds
+					<< " searches per second" << endl;
+		}
+	}
+}
+
+/**
+ * Time skewed lookups with and without a lookup cache, first on the tree
+ * from one thread and then on a concurrent tree from 1 to N threads.
+ * Ids are drawn from a Zipf-like distribution (the k-th most popular id is
+ * looked up about 1/k as often as the first), as real lookups tend to be.
+ *
+ * @param bst The tree to search
+ * @param frozen A frozen copy of the same tree
+ */
+void benchmarkCachedSearch(BinarySearchTree* bst, const FrozenBidIndex& frozen) {
+	const vector<Bid>& sorted = frozen.Sorted();
+	if (sorted.empty())
+		return;
+
+	const int lookups = 400000;
+	mt19937 rng(42);
+
+	// Popularity ranks are assigned to the ids at random
+	vector<int> byRank(sorted.size());
+	for (unsigned i = 0; i < byRank.size(); ++i)
+		byRank[i] = i;
+	shuffle(byRank.begin(), byRank.end(), rng);
+
+	vector<double> cumulative(sorted.size());
+	double total = 0.0;
+	for (unsigned k = 0; k < cumulative.size(); ++k) {
+		total += 1.0 / (k + 1);
+		cumulative[k] = total;
+	}
+
+	uniform_real_distribution<double> uniform(0.0, total);
+	vector<string> queries;
+	queries.reserve(lookups);
+	for (int i = 0; i < lookups; ++i) {
+		unsigned k = lower_bound(cumulative.begin(), cumulative.end(), uniform(rng)) - cumulative.begin();
+		queries.push_back(sorted[byRank[min<size_t>(k, sorted.size() - 1)]].bidId);
+	}
+
+	clock_t ticks;
+	long found;
+
+	cout << "one thread, " << DEFAULT_CACHE_CAPACITY << " cached of " << sorted.size() << " bids:" << endl;
+
+	ticks = clock();
+	found = 0;
+	for (const string& q : queries)
+		found += !bst->Search(q).bidId.empty();
+	ticks = clock() - ticks;
+	cout << "  uncached: " << found << " found, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+	CachedContainer<BinarySearchTree> cached(bst);
+	ticks = clock();
+	found = 0;
+	for (const string& q : queries)
+		found += !cached.Search(q).bidId.empty();
+	ticks = clock() - ticks;
+	cout << "  cached:   " << found << " found, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds, "
+			<< cached.Cache().HitRate() * 100 << "% hits, " << cached.Cache().Evictions() << " evictions" << endl;
+
+	// The concurrent tree, shared by all the readers
+	ConcurrentBinarySearchTree tree;
+	insertBalanced(tree, sorted, 0, sorted.size());
+
+	const unsigned shards = 16;
+	unsigned maxThreads = max(4u, thread::hardware_concurrency());
+
+	cout << "concurrent tree, " << shards << " cache shards:" << endl;
+
+	for (unsigned threads = 1; threads <= maxThreads; threads *= 2) {
+		CachedContainer<ConcurrentBinarySearchTree> sharedCache(&tree, DEFAULT_CACHE_CAPACITY, shards);
+		double rates[2];
+
+		for (int useCache = 0; useCache < 2; ++useCache) {
+			vector<thread> readers;
+
+			// Wall-clock time: clock() would add up every thread's CPU time
+			auto start = chrono::steady_clock::now();
+
+			for (unsigned t = 0; t < threads; ++t) {
+				readers.emplace_back([&, t, useCache]() {
+					// Each thread walks the same skewed stream from its own offset
+					size_t offset = t * queries.size() / threads;
+					for (size_t i = 0; i < queries.size(); ++i) {
+						const string& q = queries[(offset + i) % queries.size()];
+						if (useCache)
+							sharedCache.Search(q);
+						else
+							tree.Search(q);
+					}
+				});
+			}
+
+			for (thread& reader : readers)
+				reader.join();
+
+			double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			rates[useCache] = threads * queries.size() / seconds;
+		}
+
+		cout << "  " << threads << " threads: " << rates[0] << " searches per second uncached, "
+				<< rates[1] << " cached (" << sharedCache.Cache().HitRate() * 100 << "% hits, "
+				<< sharedCache.Cache().Evictions() << " evictions)" << endl;
+	}
+}
+
+/**
+ * Prompt for a query using console (std::in); blank answers match anything
+ *
+ * @return the query entered
+ */
+BidQuery getBidQuery() {
+	BidQuery query;
+	string line;
+
+	cin.ignore();
+	cout << "Fund (blank for any): ";
+	getline(cin, query.fund);
+
+	cout << "Title starts with (blank for any): ";
+	getline(cin, query.titlePrefix);
+
+	cout << "Title contains (blank for any): ";
+	getline(cin, query.titleContains);
+
+	cout << "Minimum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.minAmount = strToDouble(line, '$');
+	}
+
+	cout << "Maximum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.maxAmount = strToDouble(line, '$');
+	}
+
+	return query;
+}
+
 /**
  * Load a CSV file containing bids into a container
+ * The rows are collected first and the tree is then built in one pass.
  *
  * @param csvPath the path to the CSV file to load
  * @return a container holding all the bids read
  */
-void loadBids(string csvPath, BinarySearchTree* bst) {
+void loadBids(string csvPath, BinarySearchTree* bst, TitleIndex* titleIndex = nullptr) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // initialize the CSV Parser using the given path
@@ -301,6 +2388,9 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
     }
     cout << "" << endl;
 
+    vector<Bid> bids;
+    bids.reserve(file.rowCount());
+
     try {
         // loop to read rows of a CSV file
         for (unsigned int i = 0; i < file.rowCount(); i++) {
@@ -315,11 +2405,22 @@ void loadBids(string csvPath, BinarySearchTree* bst) {
             //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
 
             // push this bid to the end
-            bst->Insert(bid);
+            bids.push_back(bid);
         }
     } catch (csv::Error &e) {
         std::cerr << e.what() << std::endl;
     }
+
+    // Index the titles alongside (before the build moves the bids into the tree)
+    if (titleIndex != nullptr) {
+        titleIndex->Clear();
+        for (const Bid& loaded : bids) {
+            titleIndex->Add(loaded);
+        }
+    }
+
+    // Replace the tree with a balanced one in linear time
+    bst->BuildFromSorted(bids);
 }
 
 /**
@@ -362,6 +2463,24 @@ int main(int argc, char* argv[]) {
     // Define a binary search tree to hold all bids
     BinarySearchTree* bst = new BinarySearchTree;
 
+    // Read-only copy of the tree, made on demand
+    FrozenBidIndex frozen;
+    const Bid* frozenBid;
+
+    // Persistent copy of the tree, kept in step with it, and saved versions of it
+    PersistentBinarySearchTree history;
+    bool historyCurrent = false;
+    vector<PersistentBinarySearchTree> snapshots;
+    unsigned snapshot;
+
+    // Full-text index of the titles, kept in step with the tree
+    TitleIndex titleIndex;
+    string titleQuery;
+    vector<string> titleMatches;
+
+    // Lookup cache in front of the tree
+    CachedContainer<BinarySearchTree> cachedBst(bst);
+
     Bid bid;
 
     int choice = 0;
@@ -371,6 +2490,16 @@ int main(int argc, char* argv[]) {
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Freeze Bids" << endl;
+        cout << "  6. Find Frozen Bid" << endl;
+        cout << "  7. Benchmark Search" << endl;
+        cout << "  8. Benchmark Concurrent Search" << endl;
+        cout << "  10. Take Snapshot" << endl;
+        cout << "  11. Find Bid In Snapshot" << endl;
+        cout << "  12. Search Titles" << endl;
+        cout << "  13. Find Bid (cached)" << endl;
+        cout << "  14. Benchmark Cached Search" << endl;
+        cout << "  15. Query Bids" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -382,7 +2511,15 @@ int main(int argc, char* argv[]) {
             ticks = clock();
 
             // Complete the method call to load the bids
-            loadBids(csvPath, bst);
+            loadBids(csvPath, bst, &titleIndex);
+            cachedBst.Invalidate();
+
+            // Any frozen copy is now out of date
+            frozen = FrozenBidIndex();
+
+            // The persistent copy is rebuilt when the next snapshot is taken
+            history = PersistentBinarySearchTree();
+            historyCurrent = false;
 
             //cout << bst->Size() << " bids read" << endl;
 
@@ -415,12 +2552,169 @@ int main(int argc, char* argv[]) {
             break;
 
         case 4:
-            bst->Remove(bidKey);
+            // Through the cache, so it does not keep serving the bid
+            cachedBst.Remove(bidKey);
+
+            // Any frozen copy is now out of date
+            frozen = FrozenBidIndex();
+
+            // Earlier snapshots keep the bid
+            if (historyCurrent) {
+                history = history.Remove(bidKey);
+            }
+
+            titleIndex.Remove(bidKey);
+            break;
+
+        case 5:
+            ticks = clock();
+
+            frozen = bst->Freeze();
+
+            ticks = clock() - ticks;
+            cout << frozen.Size() << " bids frozen" << endl;
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 6:
+            ticks = clock();
+
+            frozenBid = frozen.Find(bidKey);
+
+            ticks = clock() - ticks;
+
+            if (frozenBid) {
+                displayBid(*frozenBid);
+            } else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 7:
+            // Search the current contents
+            frozen = bst->Freeze();
+            benchmarkSearch(bst, frozen);
+            break;
+
+        case 8:
+            frozen = bst->Freeze();
+            benchmarkConcurrentSearch(frozen);
+            break;
+
+        case 10:
+            // The first snapshot since a load builds the persistent copy in O(n)
+            if (!historyCurrent) {
+                history = PersistentBinarySearchTree::FromSorted(bst->Export());
+                historyCurrent = true;
+            }
+
+            // O(1): the snapshot shares every node with the current version
+            snapshots.push_back(history);
+            cout << "Snapshot " << snapshots.size() << ": " << history.Size() << " bids" << endl;
+            break;
+
+        case 11:
+            cout << "Enter snapshot (1-" << snapshots.size() << "): ";
+            cin >> snapshot;
+
+            if (snapshot < 1 || snapshot > snapshots.size()) {
+                cout << "No such snapshot." << endl;
+                break;
+            }
+
+            ticks = clock();
+
+            bid = snapshots[snapshot - 1].Search(bidKey);
+
+            ticks = clock() - ticks;
+
+            if (!bid.bidId.empty()) {
+                displayBid(bid);
+            } else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 12:
+            cout << "Search (words are ANDed, OR between words, * for a prefix): ";
+            cin.ignore();
+            getline(cin, titleQuery);
+
+            ticks = clock();
+
+            titleMatches = titleIndex.Search(titleQuery);
+
+            ticks = clock() - ticks;
+
+            for (const string& match : titleMatches) {
+                const Bid* found = bst->Find(match);
+                if (found) {
+                    displayBid(*found);
+                }
+            }
+            cout << titleMatches.size() << " bids found ("
+                    << titleIndex.TermCount() << " terms, " << titleIndex.PostingBytes() << " bytes of postings)" << endl;
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 13:
+            ticks = clock();
+
+            bid = cachedBst.Search(bidKey);
+
+            ticks = clock() - ticks;
+
+            if (!bid.bidId.empty()) {
+                displayBid(bid);
+            } else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "cache: " << cachedBst.Cache().HitRate() * 100 << "% hits, "
+                    << cachedBst.Cache().Evictions() << " evictions" << endl;
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 14:
+            frozen = bst->Freeze();
+            benchmarkCachedSearch(bst, frozen);
+            break;
+
+        case 15: {
+            BidQuery query = getBidQuery();
+            string plan;
+
+            ticks = clock();
+
+            vector<Bid> matches = bst->Query(query, &plan);
+
+            ticks = clock() - ticks;
+
+            for (const Bid& match : matches) {
+                displayBid(match);
+            }
+            cout << matches.size() << " bids found (" << plan << ")" << endl;
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
             break;
         }
+        }
     }
 
     cout << "Good bye." << endl;
 
+    delete bst;
+
 	return 0;
 }
@@ -1,8 +1,13 @@
 #include <algorithm>
 #include <climits>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <map>
 #include <string> // atoi
 #include <time.h>
+#include <unordered_map>
+#include <unordered_set>
 
 // (borrowed)
 #include "CSVparser.hpp"
@@ -16,6 +21,9 @@ using namespace std;
 // Used for this implementaton. Consider a larger size for a real scenario
 const unsigned int DEFAULT_SIZE = 179;
 
+// How many bids the membership filter is sized for by default
+const size_t DEFAULT_FILTER_CAPACITY = 1 << 16;
+
 // forward declarations
 double strToDouble(string str, char ch);
 
@@ -38,6 +46,54 @@ ostream& operator<<(ostream& os, const Bid& bid) {
 	return os;
 }
 
+//============================================================================
+// Secondary indexes: look bids up by fund, amount or title, not just bidId
+//============================================================================
+
+/**
+ * A query over bid fields; empty / infinite fields match anything
+ */
+struct BidQuery {
+	// Exact fund
+	string fund;
+	// Title starts with
+	string titlePrefix;
+	// Title contains (no index can answer this alone)
+	string titleContains;
+	// Inclusive amount range
+	double minAmount;
+	double maxAmount;
+
+	BidQuery() {
+		minAmount = -HUGE_VAL;
+		maxAmount = HUGE_VAL;
+	}
+
+	bool Matches(const Bid& bid) const;
+};
+
+/**
+ * Secondary indexes mapping field values to bidIds:
+ * a hash index on fund, and ordered indexes on amount (for ranges)
+ * and title (for prefixes). The owner keeps them in step with its
+ * inserts and removes.
+ */
+class BidIndexes {
+
+private:
+
+	// A multiset, as the table itself allows duplicate ids
+	unordered_map<string, unordered_multiset<string>> byFund;
+	multimap<double, string> byAmount;
+	multimap<string, string> byTitle;
+
+public:
+	void Add(const Bid& bid);
+	void Remove(const Bid& bid);
+	void Clear();
+	bool Candidates(const BidQuery& query, vector<string>& bidIds, string& indexUsed) const;
+};
+
 //============================================================================
 // Hash Table class definition
 //============================================================================
@@ -83,6 +139,9 @@ private:
 	// Hash table = array of linked lists
 	vector<Node> nodes;
 
+	// Lookups by fields other than bidId
+	BidIndexes indexes;
+
     unsigned int hash(int key);
 
 public:
@@ -92,8 +151,158 @@ public:
     void PrintAll();
     void Remove(string bidId);
     Bid Search(string bidId);
+    vector<Bid> Query(const BidQuery& query, string* plan = nullptr);
 };
 
+/**
+ * Whether a bid satisfies every field of the query
+ */
+bool BidQuery::Matches(const Bid& bid) const {
+	return (fund.empty() || bid.fund == fund)
+			&& bid.title.compare(0, titlePrefix.size(), titlePrefix) == 0
+			&& (titleContains.empty() || bid.title.find(titleContains) != string::npos)
+			&& bid.amount >= minAmount && bid.amount <= maxAmount;
+}
+
+/**
+ * Index a bid
+ *
+ * @param bid The bid to index
+ */
+void BidIndexes::Add(const Bid& bid) {
+	byFund[bid.fund].insert(bid.bidId);
+	byAmount.emplace(bid.amount, bid.bidId);
+	byTitle.emplace(bid.title, bid.bidId);
+}
+
+/**
+ * Drop a bid from every index
+ *
+ * @param bid The bid as it was indexed
+ */
+void BidIndexes::Remove(const Bid& bid) {
+	auto fund = byFund.find(bid.fund);
+	if (fund != byFund.end()) {
+		unordered_multiset<string>& ids = fund->second;
+
+		// A fund holds a large share of the table, so no linear search here
+		auto found = ids.find(bid.bidId);
+		if (found != ids.end()) {
+			ids.erase(found);
+		}
+		if (ids.empty()) {
+			byFund.erase(fund);
+		}
+	}
+
+	auto amounts = byAmount.equal_range(bid.amount);
+	for (auto it = amounts.first; it != amounts.second; ++it) {
+		if (it->second == bid.bidId) {
+			byAmount.erase(it);
+			break;
+		}
+	}
+
+	auto titles = byTitle.equal_range(bid.title);
+	for (auto it = titles.first; it != titles.second; ++it) {
+		if (it->second == bid.bidId) {
+			byTitle.erase(it);
+			break;
+		}
+	}
+}
+
+/**
+ * Empty every index
+ */
+void BidIndexes::Clear() {
+	byFund.clear();
+	byAmount.clear();
+	byTitle.clear();
+}
+
+/**
+ * Candidate bidIds for a query from the most selective index that applies.
+ * A fund lookup is exact and counted in O(1); the ordered indexes are only
+ * counted up to the best count so far, so estimating never costs more than
+ * reading the winner. The caller still checks every field of each candidate.
+ *
+ * @param query The query to answer
+ * @param bidIds Receives the candidate ids
+ * @param indexUsed Receives the name of the index chosen
+ * @return false if no index applies and the caller has to scan
+ */
+bool BidIndexes::Candidates(const BidQuery& query, vector<string>& bidIds, string& indexUsed) const {
+	bool haveFund = !query.fund.empty();
+	bool haveAmount = query.minAmount > -HUGE_VAL || query.maxAmount < HUGE_VAL;
+	bool haveTitle = !query.titlePrefix.empty();
+
+	if (!haveFund && !haveAmount && !haveTitle) {
+		return false;
+	}
+
+	size_t best = SIZE_MAX;
+	auto fund = byFund.end();
+
+	if (haveFund) {
+		fund = byFund.find(query.fund);
+		best = (fund == byFund.end()) ? 0 : fund->second.size();
+		indexUsed = "fund";
+	}
+
+	auto amountBegin = byAmount.lower_bound(query.minAmount);
+	auto amountEnd = byAmount.upper_bound(query.maxAmount);
+	if (haveAmount && best > 0 && query.minAmount <= query.maxAmount) {
+		size_t count = 0;
+		for (auto it = amountBegin; it != amountEnd && count < best; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "amount";
+		}
+	}
+	else if (haveAmount && query.minAmount > query.maxAmount) {
+		// An empty range: nothing can match
+		best = 0;
+		indexUsed = "amount";
+		amountBegin = amountEnd = byAmount.end();
+	}
+
+	// Prefix matches run from the prefix up to the first title that doesn't start with it
+	auto titleBegin = byTitle.lower_bound(query.titlePrefix);
+	if (haveTitle && best > 0) {
+		size_t count = 0;
+		for (auto it = titleBegin; it != byTitle.end() && count < best
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "title";
+		}
+	}
+
+	bidIds.clear();
+	if (indexUsed == "fund") {
+		if (fund != byFund.end()) {
+			bidIds.assign(fund->second.begin(), fund->second.end());
+		}
+	}
+	else if (indexUsed == "amount") {
+		for (auto it = amountBegin; it != amountEnd; ++it) {
+			bidIds.push_back(it->second);
+		}
+	}
+	else {
+		for (auto it = titleBegin; it != byTitle.end()
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			bidIds.push_back(it->second);
+		}
+	}
+	return true;
+}
+
 /**
  * Parameterised ctor that doubles as a default ctor
  * Pass in a different size or let it take the default value
@@ -133,6 +342,9 @@ unsigned int HashTable::hash(int key) {
 void HashTable::Insert(Bid bid) {
     unsigned key = hash(stoi(bid.bidId));
 
+    // Keep the secondary indexes in step
+    indexes.Add(bid);
+
     // Get an existing node, if any.
     // [] preferred over at() because hashing ensures valid indices
     Node* existingNode = &(nodes[key]);
@@ -219,11 +431,22 @@ void HashTable::Remove(string bidId) {
 
     // If deleting the first element
     if (node->key != UINT_MAX && node->bid.bidId == bidId) {
-    	// Make the next node the first node
-    	nodes[key] = *(node->next);
+    	indexes.Remove(node->bid);
+
+    	Node* next = node->next;
+
+    	// The only node: mark the bucket open again
+    	if (next == nullptr) {
+    		*node = Node();
+    		return;
+    	}
 
-    	// Delink the current node
-    	node->next = nullptr;
+    	// Otherwise make the next node the first node (keeping the rest of the chain)
+    	*node = *next;
+
+    	// Delink and free the old second node, now copied into the bucket
+    	next->next = nullptr;
+    	delete next;
 
     	return;
     }
@@ -234,12 +457,15 @@ void HashTable::Remove(string bidId) {
     while (node != nullptr) {
     	// Match found
     	if (node->key != UINT_MAX && node->bid.bidId == bidId) {
+    		indexes.Remove(node->bid);
+
     		// Join the last node to the next node.
     		// So A -> B -> C becomes A -> C
     		prevNode->next = node->next;
 
-    		// Delink the current node
+    		// Delink and free the current node
     		node->next = nullptr;
+    		delete node;
 
     		// Reasonable to break because bidId is a primary key
     		break;
@@ -286,6 +512,368 @@ Bid HashTable::Search(string bidId) {
     return bid;
 }
 
+/**
+ * Find the bids matching a query, through the most selective
+ * secondary index, or by scanning every bucket if none applies
+ *
+ * @param query The fields to match
+ * @param plan If given, receives how the query was answered
+ * @return The matching bids
+ */
+vector<Bid> HashTable::Query(const BidQuery& query, string* plan) {
+	vector<Bid> matches;
+	vector<string> bidIds;
+	string indexUsed;
+
+	if (indexes.Candidates(query, bidIds, indexUsed)) {
+		if (plan != nullptr) {
+			*plan = indexUsed + " index, " + to_string(bidIds.size()) + " candidates";
+		}
+
+		// An id can be stored more than once, and Search only returns the
+		// first. Walk each candidate id's chain once and check every entry
+		// with that id, so the result agrees with the full scan.
+		unordered_set<string> visited;
+		for (const string& bidId : bidIds) {
+			if (!visited.insert(bidId).second) {
+				continue;
+			}
+
+			for (Node* node = &(nodes[hash(stoi(bidId))]); node != nullptr; node = node->next) {
+				if (node->key != UINT_MAX && node->bid.bidId == bidId && query.Matches(node->bid)) {
+					matches.push_back(node->bid);
+				}
+			}
+		}
+		return matches;
+	}
+
+	if (plan != nullptr) {
+		*plan = "full scan";
+	}
+
+	for (unsigned i = 0; i < tableSize; ++i) {
+		for (Node* node = &(nodes[i]); node != nullptr; node = node->next) {
+			if (node->key != UINT_MAX && query.Matches(node->bid)) {
+				matches.push_back(node->bid);
+			}
+		}
+	}
+	return matches;
+}
+
+//============================================================================
+// Cuckoo filter: approximate membership test in front of a container
+//============================================================================
+
+/**
+ * Answers "might this bidId be stored?" in a few bytes per bid.
+ * Each key leaves a 16-bit fingerprint in one of two 8-byte buckets of
+ * four slots; the second bucket is the first XOR a hash of the
+ * fingerprint, so either can be found from the other when entries are
+ * kicked between them. A "no" is always right; a "yes" is wrong with
+ * probability about 8 * load / 65536. Unlike a Bloom filter, keys can
+ * be deleted (but only keys that were added).
+ */
+class CuckooFilter {
+
+private:
+
+	static const unsigned SLOTS = 4;
+	static const unsigned MAX_KICKS = 500;
+
+	struct Bucket {
+		// 0 = empty
+		uint16_t slots[SLOTS];
+	};
+
+	vector<Bucket> buckets;
+	size_t mask;
+	size_t count;
+
+	// A fingerprint that found no room after MAX_KICKS moves
+	bool hasVictim;
+	size_t victimIndex;
+	uint16_t victimFingerprint;
+
+	// Set once even the victim slot is taken; from then on every lookup says "maybe"
+	bool saturated;
+
+	// State for picking which entry to kick
+	uint64_t seed;
+
+	static uint64_t Hash(const string& key);
+	size_t AltIndex(size_t index, uint16_t fingerprint) const;
+	void Locate(const string& key, size_t& first, size_t& second, uint16_t& fingerprint) const;
+	bool Place(size_t index, uint16_t fingerprint);
+
+public:
+	CuckooFilter(size_t capacity = DEFAULT_FILTER_CAPACITY);
+	void Add(const string& key);
+	bool MayContain(const string& key) const;
+	bool Delete(const string& key);
+	size_t Size() const { return count; }
+	double LoadFactor() const { return count * 1.0 / (buckets.size() * SLOTS); }
+	double ExpectedFalsePositiveRate() const;
+	bool Saturated() const { return saturated; }
+	size_t MemoryUsage() const { return buckets.size() * sizeof(Bucket); }
+};
+
+/**
+ * Size the table for capacity keys at up to 95% load
+ * (bucket count rounded up to a power of two)
+ */
+CuckooFilter::CuckooFilter(size_t capacity) {
+	size_t needed = capacity / (SLOTS * 95 / 100.0) + 1;
+	size_t size = 1;
+	while (size < needed) {
+		size <<= 1;
+	}
+
+	buckets.assign(size, Bucket());
+	mask = size - 1;
+	count = 0;
+	hasVictim = false;
+	victimIndex = 0;
+	victimFingerprint = 0;
+	saturated = false;
+	seed = 0x9E3779B97F4A7C15ULL;
+}
+
+/**
+ * 64-bit hash of a key: FNV-1a, then a final mix so every bit depends on every byte
+ */
+uint64_t CuckooFilter::Hash(const string& key) {
+	uint64_t hash = 0xCBF29CE484222325ULL;
+	for (char c : key) {
+		hash ^= (unsigned char) c;
+		hash *= 0x100000001B3ULL;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xFF51AFD7ED558CCDULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+/**
+ * The other bucket a fingerprint may live in (works in both directions)
+ */
+size_t CuckooFilter::AltIndex(size_t index, uint16_t fingerprint) const {
+	return (index ^ (fingerprint * 0x5BD1E995ULL)) & mask;
+}
+
+/**
+ * A key's fingerprint and its two candidate buckets
+ */
+void CuckooFilter::Locate(const string& key, size_t& first, size_t& second, uint16_t& fingerprint) const {
+	uint64_t hash = Hash(key);
+
+	// Never 0, which marks an empty slot
+	fingerprint = (uint16_t) (hash >> 48);
+	if (fingerprint == 0) {
+		fingerprint = 1;
+	}
+
+	first = hash & mask;
+	second = AltIndex(first, fingerprint);
+}
+
+/**
+ * Put a fingerprint in a free slot of a bucket, if there is one
+ */
+bool CuckooFilter::Place(size_t index, uint16_t fingerprint) {
+	for (unsigned slot = 0; slot < SLOTS; ++slot) {
+		if (buckets[index].slots[slot] == 0) {
+			buckets[index].slots[slot] = fingerprint;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Record a key
+ * Both buckets full: kick a random entry to its other bucket, and
+ * repeat with whatever that displaces, up to MAX_KICKS times.
+ *
+ * @param key The key to add
+ */
+void CuckooFilter::Add(const string& key) {
+	size_t first, second;
+	uint16_t fingerprint;
+	Locate(key, first, second, fingerprint);
+
+	++count;
+
+	if (Place(first, fingerprint) || Place(second, fingerprint)) {
+		return;
+	}
+
+	size_t index = (seed & 1) ? first : second;
+	for (unsigned kick = 0; kick < MAX_KICKS; ++kick) {
+		// xorshift: cheap, and good enough to avoid kicking in cycles
+		seed ^= seed << 13;
+		seed ^= seed >> 7;
+		seed ^= seed << 17;
+
+		swap(fingerprint, buckets[index].slots[seed % SLOTS]);
+		index = AltIndex(index, fingerprint);
+
+		if (Place(index, fingerprint)) {
+			return;
+		}
+	}
+
+	// Out of room: park the homeless fingerprint, or give up on saying "no"
+	if (!hasVictim) {
+		hasVictim = true;
+		victimIndex = index;
+		victimFingerprint = fingerprint;
+	}
+	else {
+		saturated = true;
+	}
+}
+
+/**
+ * Whether a key might have been added
+ * Reads the key's two 8-byte buckets; false means it definitely wasn't
+ *
+ * @param key The key to look for
+ */
+bool CuckooFilter::MayContain(const string& key) const {
+	if (saturated) {
+		return true;
+	}
+
+	size_t first, second;
+	uint16_t fingerprint;
+	Locate(key, first, second, fingerprint);
+
+	for (unsigned slot = 0; slot < SLOTS; ++slot) {
+		if (buckets[first].slots[slot] == fingerprint || buckets[second].slots[slot] == fingerprint) {
+			return true;
+		}
+	}
+
+	return hasVictim && victimFingerprint == fingerprint
+			&& (victimIndex == first || victimIndex == second);
+}
+
+/**
+ * Forget one copy of a key. Only delete keys that were added:
+ * deleting another key's matching fingerprint would make it vanish.
+ *
+ * @param key The key to delete
+ * @return false if no matching fingerprint was found
+ */
+bool CuckooFilter::Delete(const string& key) {
+	size_t first, second;
+	uint16_t fingerprint;
+	Locate(key, first, second, fingerprint);
+
+	for (size_t index : { first, second }) {
+		for (unsigned slot = 0; slot < SLOTS; ++slot) {
+			if (buckets[index].slots[slot] == fingerprint) {
+				buckets[index].slots[slot] = 0;
+				--count;
+
+				// Room again for the parked fingerprint
+				if (hasVictim) {
+					hasVictim = false;
+					--count;
+					uint16_t victim = victimFingerprint;
+					size_t home = victimIndex;
+					if (!Place(home, victim) && !Place(AltIndex(home, victim), victim)) {
+						// Still no room: put it back where it was
+						hasVictim = true;
+					}
+					++count;
+				}
+				return true;
+			}
+		}
+	}
+
+	if (hasVictim && victimFingerprint == fingerprint && (victimIndex == first || victimIndex == second)) {
+		hasVictim = false;
+		--count;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * False-positive rate the load predicts: each of the 2 * SLOTS slots
+ * checked holds a matching fingerprint with probability load / 2^16
+ */
+double CuckooFilter::ExpectedFalsePositiveRate() const {
+	if (saturated) {
+		return 1.0;
+	}
+	return 1.0 - pow(1.0 - 1.0 / 65536, 2.0 * SLOTS * LoadFactor());
+}
+
+/**
+ * A container with a cuckoo filter in front of its lookups.
+ * Works with any container offering Insert(Bid), Remove(string) and
+ * Search(string) returning an empty Bid when not found. Misses the
+ * filter rejects never reach the container; the ones it lets through
+ * are counted, giving the observed false-positive rate.
+ */
+template <typename Container>
+class FilteredContainer {
+
+private:
+
+	Container* container;
+	CuckooFilter filter;
+
+	// Lookups for missing ids, split by whether the filter caught them
+	size_t rejected = 0;
+	size_t falsePositives = 0;
+
+public:
+	FilteredContainer(Container* container, size_t capacity = DEFAULT_FILTER_CAPACITY)
+			: container { container }, filter { capacity } {}
+
+	void Insert(Bid bid) {
+		filter.Add(bid.bidId);
+		container->Insert(bid);
+	}
+
+	void Remove(string bidId) {
+		// Only delete fingerprints of bids actually stored
+		if (filter.MayContain(bidId) && !container->Search(bidId).bidId.empty()) {
+			container->Remove(bidId);
+			filter.Delete(bidId);
+		}
+	}
+
+	Bid Search(string bidId) {
+		if (!filter.MayContain(bidId)) {
+			++rejected;
+			return Bid();
+		}
+
+		Bid bid = container->Search(bidId);
+		if (bid.bidId.empty()) {
+			++falsePositives;
+		}
+		return bid;
+	}
+
+	// Share of lookups for missing ids that still reached the container
+	double FalsePositiveRate() const {
+		size_t misses = rejected + falsePositives;
+		return misses == 0 ? 0.0 : falsePositives * 1.0 / misses;
+	}
+
+	const CuckooFilter& Filter() const { return filter; }
+};
+
 //============================================================================
 // Static methods used for testing
 //============================================================================
@@ -305,9 +893,10 @@ void displayBid(Bid bid) {
  * Load a CSV file containing bids into a container
  *
  * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * @param hashTable the container to insert into (a HashTable, or one behind a filter)
  */
-void loadBids(string csvPath, HashTable* hashTable) {
+template <typename Container>
+void loadBids(string csvPath, Container* hashTable) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // initialize the CSV Parser using the given path
@@ -341,6 +930,76 @@ void loadBids(string csvPath, HashTable* hashTable) {
     }
 }
 
+/**
+ * Time lookups of ids that aren't stored, with and without the filter
+ *
+ * @param hashTable the table itself
+ * @param filtered the same table behind its filter
+ */
+void benchmarkMissingLookups(HashTable* hashTable, FilteredContainer<HashTable>* filtered) {
+	const int lookups = 100000;
+
+	// Well above any real bidId
+	vector<string> missing;
+	for (int i = 0; i < lookups; ++i) {
+		missing.push_back(to_string(900000000 + i));
+	}
+
+	clock_t ticks = clock();
+	for (const string& bidId : missing) {
+		hashTable->Search(bidId);
+	}
+	ticks = clock() - ticks;
+	cout << "unfiltered: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds for " << lookups << " misses" << endl;
+
+	ticks = clock();
+	for (const string& bidId : missing) {
+		filtered->Search(bidId);
+	}
+	ticks = clock() - ticks;
+	cout << "filtered: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds for " << lookups << " misses" << endl;
+
+	const CuckooFilter& filter = filtered->Filter();
+	cout << "filter: " << filter.Size() << " keys, load " << filter.LoadFactor()
+			<< ", " << filter.MemoryUsage() << " bytes" << (filter.Saturated() ? ", saturated" : "") << endl;
+	cout << "false positive rate: observed " << filtered->FalsePositiveRate()
+			<< ", expected " << filter.ExpectedFalsePositiveRate() << endl;
+}
+
+/**
+ * Prompt for a query using console (std::in); blank answers match anything
+ *
+ * @return the query entered
+ */
+BidQuery getBidQuery() {
+	BidQuery query;
+	string line;
+
+	cin.ignore();
+	cout << "Fund (blank for any): ";
+	getline(cin, query.fund);
+
+	cout << "Title starts with (blank for any): ";
+	getline(cin, query.titlePrefix);
+
+	cout << "Title contains (blank for any): ";
+	getline(cin, query.titleContains);
+
+	cout << "Minimum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.minAmount = strToDouble(line, '$');
+	}
+
+	cout << "Maximum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.maxAmount = strToDouble(line, '$');
+	}
+
+	return query;
+}
+
 /**
  * Simple C function to convert a string to a double
  * after stripping out unwanted char
@@ -381,6 +1040,9 @@ int main(int argc, char* argv[]) {
     // Define a hash table to hold all the bids
     HashTable* bidTable;
 
+    // The same table behind a membership filter
+    FilteredContainer<HashTable>* filteredTable = nullptr;
+
     Bid bid;
 
     int choice = 0;
@@ -390,6 +1052,9 @@ int main(int argc, char* argv[]) {
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Find Bid" << endl;
         cout << "  4. Remove Bid" << endl;
+        cout << "  5. Query Bids" << endl;
+        cout << "  6. Find Bid (filtered)" << endl;
+        cout << "  7. Benchmark Missing Bid Lookups" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -399,11 +1064,14 @@ int main(int argc, char* argv[]) {
         case 1:
             bidTable = new HashTable();
 
+            delete filteredTable;
+            filteredTable = new FilteredContainer<HashTable>(bidTable);
+
             // Initialize a timer variable before loading bids
             ticks = clock();
 
-            // Complete the method call to load the bids
-            loadBids(csvPath, bidTable);
+            // Load through the filter, so it sees every bid
+            loadBids(csvPath, filteredTable);
 
             // Calculate elapsed time and display result
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
@@ -433,12 +1101,56 @@ int main(int argc, char* argv[]) {
             break;
 
         case 4:
-            bidTable->Remove(bidKey);
+            // Through the filter, so it forgets the bid too
+            filteredTable->Remove(bidKey);
+            break;
+
+        case 5: {
+            BidQuery query = getBidQuery();
+            string plan;
+
+            ticks = clock();
+
+            vector<Bid> matches = bidTable->Query(query, &plan);
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+            for (const Bid& match : matches) {
+                displayBid(match);
+            }
+            cout << matches.size() << " bids found (" << plan << ")" << endl;
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+        }
+
+        case 6:
+            ticks = clock();
+
+            bid = filteredTable->Search(bidKey);
+
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+
+            if (!bid.bidId.empty()) {
+                displayBid(bid);
+            } else {
+                cout << "Bid Id " << bidKey << " not found." << endl;
+            }
+
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            break;
+
+        case 7:
+            benchmarkMissingLookups(bidTable, filteredTable);
             break;
         }
     }
 
     cout << "Good bye." << endl;
 
+    delete filteredTable;
+
     return 0;
 }
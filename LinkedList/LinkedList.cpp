@@ -1,6 +1,18 @@
 #include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <random>
+#include <shared_mutex>
+#include <thread>
 #include <time.h>
+#include <unordered_map>
+#include <unordered_set>
 
 // (borrowed)
 #include "CSVparser.hpp"
@@ -28,6 +40,220 @@ struct Bid {
 // forward declaration
 void displayBid(Bid bid);
 
+/**
+ * The operations shared by every list of bids,
+ * so that the program can switch between implementations
+ */
+class BidList {
+
+public:
+    virtual ~BidList() {}
+    virtual void Append(Bid bid) = 0;
+    virtual void Prepend(Bid bid) = 0;
+    virtual void PrintList() = 0;
+    virtual void Remove(string bidId) = 0;
+    virtual Bid Search(string bidId) = 0;
+    virtual int Size() = 0;
+
+    // Append a batch of bids (moved out of the vector)
+    virtual void AppendRange(vector<Bid>& bids) {
+        for (Bid& bid : bids)
+            Append(move(bid));
+    }
+};
+
+//============================================================================
+// Secondary indexes: look bids up by fund, amount or title, not just bidId
+//============================================================================
+
+/**
+ * A query over bid fields; empty / infinite fields match anything
+ * (Copied from HashTable)
+ */
+struct BidQuery {
+	// Exact fund
+	string fund;
+	// Title starts with
+	string titlePrefix;
+	// Title contains (no index can answer this alone)
+	string titleContains;
+	// Inclusive amount range
+	double minAmount;
+	double maxAmount;
+
+	BidQuery() {
+		minAmount = -HUGE_VAL;
+		maxAmount = HUGE_VAL;
+	}
+
+	bool Matches(const Bid& bid) const;
+};
+
+/**
+ * Secondary indexes mapping field values to bids.
+ * List nodes never move, so unlike HashTable's version these point
+ * straight at each node's bid: repeated ids are told apart and a
+ * query needs no lookup by id.
+ * (Adapted from HashTable)
+ */
+class BidIndexes {
+
+private:
+
+	unordered_map<string, unordered_set<const Bid*>> byFund;
+	multimap<double, const Bid*> byAmount;
+	multimap<string, const Bid*> byTitle;
+
+public:
+	void Add(const Bid* bid);
+	void Remove(const Bid* bid);
+	void Clear();
+	bool Candidates(const BidQuery& query, vector<const Bid*>& bids, string& indexUsed) const;
+};
+
+/**
+ * Whether a bid satisfies every field of the query
+ */
+bool BidQuery::Matches(const Bid& bid) const {
+	return (fund.empty() || bid.fund == fund)
+			&& bid.title.compare(0, titlePrefix.size(), titlePrefix) == 0
+			&& (titleContains.empty() || bid.title.find(titleContains) != string::npos)
+			&& bid.amount >= minAmount && bid.amount <= maxAmount;
+}
+
+/**
+ * Index a bid
+ *
+ * @param bid The bid to index, which must stay where it is until removed
+ */
+void BidIndexes::Add(const Bid* bid) {
+	byFund[bid->fund].insert(bid);
+	byAmount.emplace(bid->amount, bid);
+	byTitle.emplace(bid->title, bid);
+}
+
+/**
+ * Drop a bid from every index
+ *
+ * @param bid The bid as it was indexed
+ */
+void BidIndexes::Remove(const Bid* bid) {
+	auto fund = byFund.find(bid->fund);
+	if (fund != byFund.end()) {
+		fund->second.erase(bid);
+		if (fund->second.empty()) {
+			byFund.erase(fund);
+		}
+	}
+
+	auto amounts = byAmount.equal_range(bid->amount);
+	for (auto it = amounts.first; it != amounts.second; ++it) {
+		if (it->second == bid) {
+			byAmount.erase(it);
+			break;
+		}
+	}
+
+	auto titles = byTitle.equal_range(bid->title);
+	for (auto it = titles.first; it != titles.second; ++it) {
+		if (it->second == bid) {
+			byTitle.erase(it);
+			break;
+		}
+	}
+}
+
+/**
+ * Empty every index
+ */
+void BidIndexes::Clear() {
+	byFund.clear();
+	byAmount.clear();
+	byTitle.clear();
+}
+
+/**
+ * Candidate bids for a query from the most selective index that applies.
+ * A fund lookup is exact and counted in O(1); the ordered indexes are only
+ * counted up to the best count so far, so estimating never costs more than
+ * reading the winner. The caller still checks every field of each candidate.
+ *
+ * @param query The query to answer
+ * @param bids Receives the candidate bids
+ * @param indexUsed Receives the name of the index chosen
+ * @return false if no index applies and the caller has to scan
+ */
+bool BidIndexes::Candidates(const BidQuery& query, vector<const Bid*>& bids, string& indexUsed) const {
+	bool haveFund = !query.fund.empty();
+	bool haveAmount = query.minAmount > -HUGE_VAL || query.maxAmount < HUGE_VAL;
+	bool haveTitle = !query.titlePrefix.empty();
+
+	if (!haveFund && !haveAmount && !haveTitle) {
+		return false;
+	}
+
+	size_t best = SIZE_MAX;
+	auto fund = byFund.end();
+
+	if (haveFund) {
+		fund = byFund.find(query.fund);
+		best = (fund == byFund.end()) ? 0 : fund->second.size();
+		indexUsed = "fund";
+	}
+
+	auto amountBegin = byAmount.lower_bound(query.minAmount);
+	auto amountEnd = byAmount.upper_bound(query.maxAmount);
+	if (haveAmount && best > 0 && query.minAmount <= query.maxAmount) {
+		size_t count = 0;
+		for (auto it = amountBegin; it != amountEnd && count < best; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "amount";
+		}
+	}
+	else if (haveAmount && query.minAmount > query.maxAmount) {
+		// An empty range: nothing can match
+		best = 0;
+		indexUsed = "amount";
+		amountBegin = amountEnd = byAmount.end();
+	}
+
+	// Prefix matches run from the prefix up to the first title that doesn't start with it
+	auto titleBegin = byTitle.lower_bound(query.titlePrefix);
+	if (haveTitle && best > 0) {
+		size_t count = 0;
+		for (auto it = titleBegin; it != byTitle.end() && count < best
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			++count;
+		}
+		if (count < best) {
+			best = count;
+			indexUsed = "title";
+		}
+	}
+
+	bids.clear();
+	if (indexUsed == "fund") {
+		if (fund != byFund.end()) {
+			bids.assign(fund->second.begin(), fund->second.end());
+		}
+	}
+	else if (indexUsed == "amount") {
+		for (auto it = amountBegin; it != amountEnd; ++it) {
+			bids.push_back(it->second);
+		}
+	}
+	else {
+		for (auto it = titleBegin; it != byTitle.end()
+				&& it->first.compare(0, query.titlePrefix.size(), query.titlePrefix) == 0; ++it) {
+			bids.push_back(it->second);
+		}
+	}
+	return true;
+}
+
 //============================================================================
 // Linked-List class definition
 //============================================================================
@@ -35,196 +261,1963 @@ void displayBid(Bid bid);
 /**
  * Define a class containing data members and methods to
  * implement a linked-list.
+ *
+ * The list is doubly linked and can keep an optional hash index from
+ * bidId to node, which makes Search and Remove O(1) while the list keeps
+ * its insertion order (like a LinkedHashMap). An indexed list also keeps
+ * secondary indexes on fund, amount and title for Query.
+ *
+ * The list owns its nodes. It can be moved but not copied, and whole
+ * lists can be spliced together without copying or allocating.
+ */
+class LinkedList : public BidList {
+
+private:
+
+	// Struct to hold node data
+	struct BidNode {
+		Bid data;
+		BidNode* next, * prev;
+
+		// Part of a block from AppendRange (freed with the block, not on its own)
+		bool inBlock;
+
+		// default ctor
+		BidNode() {
+			next = prev = nullptr;
+			inBlock = false;
+		}
+
+		// parameterised ctor
+		BidNode(Bid bid) : data { move(bid) } {
+			next = prev = nullptr;
+			inBlock = false;
+		}
+	};
+
+	// Index entry: the first node with a bidId, and how many nodes share it
+	struct IndexEntry {
+		BidNode* first;
+		int count;
+
+		IndexEntry() : first { nullptr }, count { 0 } {}
+	};
+
+	/* HOUSEKEEPING VARIABLES
+	 * Pointers to the head & tail
+	 * An int to store the size (this makes the retrieval of the size O(1) instead of O(n) in a calculation by traversal)
+	 */
+	BidNode* head, * tail;
+	int size;
+
+	// Optional index from bidId to node
+	bool indexed;
+	unordered_map<string, IndexEntry> index;
+
+	// Lookups by other fields, kept along with the bidId index
+	BidIndexes indexes;
+
+	// Node blocks allocated by AppendRange
+	vector<BidNode*> blocks;
+
+	BidNode* Find(const string& bidId);
+	void LinkTail(BidNode* node);
+	void Unlink(BidNode* node);
+	void Clear();
+
+	// Helpers for sorting
+	static BidNode* Cut(BidNode* run, int length);
+	template <typename Compare>
+	static BidNode* MergeRuns(BidNode* left, BidNode* right, Compare less, BidNode*& last);
+	void RestoreLinks();
+	void RefreshIndex();
+
+public:
+    LinkedList(bool withIndex = false);
+    virtual ~LinkedList();
+
+    // Move-only: the nodes have a single owner
+    LinkedList(const LinkedList&) = delete;
+    LinkedList& operator=(const LinkedList&) = delete;
+    LinkedList(LinkedList&& other);
+    LinkedList& operator=(LinkedList&& other);
+
+    void Append(Bid bid);
+    void Emplace(string bidId, string title, string fund, double amount);
+    void AppendRange(vector<Bid>& bids);
+    void Prepend(Bid bid);
+    void Splice(LinkedList& other);
+    static LinkedList Concat(LinkedList&& first, LinkedList&& second);
+    template <typename Compare>
+    void Sort(Compare less);
+    template <typename Compare>
+    void Merge(LinkedList& other, Compare less);
+    vector<Bid> ToVector();
+    void PrintList();
+    void Remove(string bidId);
+    Bid Search(string bidId);
+    vector<Bid> Query(const BidQuery& query, string* plan = nullptr);
+    int Size();
+};
+
+//============================================================================
+// Unrolled Linked-List class definition
+//============================================================================
+
+/**
+ * A linked list that keeps several bids in each node.
+ * A node holds the bidIds side by side plus the positions of the bids
+ * themselves in a shared store, so a search compares keys within a node
+ * before following a single pointer to the next one.
+ * Pointer hops and node allocations drop by a factor of NODE_CAPACITY.
+ */
+class UnrolledLinkedList : public BidList {
+
+private:
+
+	// Bids per node
+	static const int NODE_CAPACITY = 16;
+
+	// Struct to hold node data
+	struct BidBlock {
+		// keys[i] is the bidId of store[slots[i]]
+		string keys[NODE_CAPACITY];
+		unsigned slots[NODE_CAPACITY];
+
+		// Number of entries in use (always at the front)
+		int count;
+
+		BidBlock* next;
+
+		// default ctor
+		BidBlock() : count { 0 }, next { nullptr } {}
+	};
+
+	BidBlock* head, * tail;
+	int size;
+
+	// The bids, addressed by slot
+	vector<Bid> store;
+
+	// Slots in the store freed by Remove, reused before the store grows
+	vector<unsigned> freeSlots;
+
+	unsigned Store(Bid& bid);
+
+public:
+    UnrolledLinkedList();
+    virtual ~UnrolledLinkedList();
+
+    // Nodes are owned by the list, so it cannot be copied
+    UnrolledLinkedList(const UnrolledLinkedList&) = delete;
+    UnrolledLinkedList& operator=(const UnrolledLinkedList&) = delete;
+
+    void Append(Bid bid);
+    void Prepend(Bid bid);
+    void PrintList();
+    void Remove(string bidId);
+    Bid Search(string bidId);
+    int Size();
+};
+
+/**
+ * Default constructor
+ *
+ * @param withIndex Keep a hash index from bidId to node
+ */
+LinkedList::LinkedList(bool withIndex) : head { nullptr }, tail { nullptr }, size { 0 }, indexed { withIndex } { // Initialisations in an initialiser list
+}
+
+/**
+ * Destructor
+ */
+LinkedList::~LinkedList() {
+	Clear();
+}
+
+/**
+ * Move constructor. The other list is left empty.
+ */
+LinkedList::LinkedList(LinkedList&& other)
+	: head { other.head }, tail { other.tail }, size { other.size }, indexed { other.indexed },
+	  index { move(other.index) }, indexes { move(other.indexes) }, blocks { move(other.blocks) } {
+	other.head = other.tail = nullptr;
+	other.size = 0;
+	other.index.clear();
+	other.indexes.Clear();
+	other.blocks.clear();
+}
+
+/**
+ * Move assignment. This list's nodes are freed and the other list is left empty.
+ */
+LinkedList& LinkedList::operator=(LinkedList&& other) {
+	if (this != &other) {
+		Clear();
+
+		head = other.head;
+		tail = other.tail;
+		size = other.size;
+		indexed = other.indexed;
+		index = move(other.index);
+		indexes = move(other.indexes);
+		blocks = move(other.blocks);
+
+		other.head = other.tail = nullptr;
+		other.size = 0;
+		other.index.clear();
+		other.indexes.Clear();
+		other.blocks.clear();
+	}
+	return *this;
+}
+
+/**
+ * Free every node and block
+ */
+void LinkedList::Clear() {
+	// Nodes allocated on their own are freed one by one...
+	while (head != nullptr) {
+		BidNode* next = head->next;
+		if (!head->inBlock)
+			delete head;
+		head = next;
+	}
+
+	// ...and the rest go with their blocks
+	for (BidNode* block : blocks)
+		delete[] block;
+
+	tail = nullptr;
+	size = 0;
+	index.clear();
+	indexes.Clear();
+	blocks.clear();
+}
+
+/**
+ * Append a new bid to the end of the list
+ */
+void LinkedList::Append(Bid bid) {
+	// new data node (the bid is moved, not copied)
+	LinkTail(new BidNode(move(bid)));
+}
+
+/**
+ * Append a new bid built from its fields, directly in its node
+ */
+void LinkedList::Emplace(string bidId, string title, string fund, double amount) {
+	BidNode* newNode = new BidNode();
+	newNode->data.bidId = move(bidId);
+	newNode->data.title = move(title);
+	newNode->data.fund = move(fund);
+	newNode->data.amount = amount;
+
+	LinkTail(newNode);
+}
+
+/**
+ * Append a batch of bids with a single allocation for all their nodes
+ *
+ * @param bids The bids to append. Their data is moved into the list.
+ */
+void LinkedList::AppendRange(vector<Bid>& bids) {
+	if (bids.empty())
+		return;
+
+	BidNode* block = new BidNode[bids.size()];
+	blocks.push_back(block);
+
+	for (unsigned i = 0; i < bids.size(); ++i) {
+		block[i].data = move(bids[i]);
+		block[i].inBlock = true;
+		LinkTail(&block[i]);
+	}
+}
+
+/**
+ * Move every node of another list to the end of this one.
+ * O(1) with no copying or allocation (plus an index update when this list is indexed).
+ * The other list is left empty.
+ */
+void LinkedList::Splice(LinkedList& other) {
+	if (this == &other || other.head == nullptr)
+		return;
+
+	// Index the incoming nodes; earlier nodes with the same ID stay first
+	if (indexed) {
+		for (BidNode* node = other.head; node != nullptr; node = node->next) {
+			IndexEntry& entry = index[node->data.bidId];
+			if (entry.count++ == 0)
+				entry.first = node;
+			indexes.Add(&node->data);
+		}
+	}
+
+	// Join the two chains
+	if (head == nullptr) {
+		head = other.head;
+	}
+	else {
+		tail->next = other.head;
+		other.head->prev = tail;
+	}
+	tail = other.tail;
+	size += other.size;
+
+	// The blocks go with their nodes
+	blocks.insert(blocks.end(), other.blocks.begin(), other.blocks.end());
+
+	other.head = other.tail = nullptr;
+	other.size = 0;
+	other.index.clear();
+	other.indexes.Clear();
+	other.blocks.clear();
+}
+
+/**
+ * Join two lists into one, the first followed by the second, without copying
+ */
+LinkedList LinkedList::Concat(LinkedList&& first, LinkedList&& second) {
+	LinkedList result(move(first));
+	result.Splice(second);
+	return result;
+}
+
+/**
+ * Link a new node in after the tail
+ */
+void LinkedList::LinkTail(BidNode* newNode) {
+	// The first element is both the head & the tail
+	if (head == nullptr) {
+		head = tail = newNode;
+	}
+
+	// Else, add the new element after the tail and make it the new tail
+	else {
+		newNode->prev = tail;
+		tail->next = newNode;
+		tail = newNode;
+	}
+
+	// An earlier node with the same ID stays the first one
+	if (indexed) {
+		IndexEntry& entry = index[newNode->data.bidId];
+		if (entry.count++ == 0)
+			entry.first = newNode;
+		indexes.Add(&newNode->data);
+	}
+
+	++size; // We just added a node
+}
+
+/**
+ * Prepend a new bid to the start of the list
  */
-class LinkedList {
+void LinkedList::Prepend(Bid bid) {
+	BidNode* newNode = new BidNode(move(bid)); // new data node
+
+	// The first element is both the head & the tail
+	if (head == nullptr) {
+		head = tail = newNode;
+	}
+
+	// Else, add the new element before the head and make it the new head
+	else {
+		newNode->next = head;
+		head->prev = newNode;
+		head = newNode;
+	}
+
+	// The new node comes before any others with the same ID
+	if (indexed) {
+		IndexEntry& entry = index[newNode->data.bidId];
+		entry.first = newNode;
+		++entry.count;
+		indexes.Add(&newNode->data);
+	}
+
+	++size; // We just added a node
+}
+
+/**
+ * Simple output of all bids in the list
+ */
+void LinkedList::PrintList() {
+	// Start at the head
+	BidNode* curNode = head;
+
+	/* TRAVERSAL LOGIC
+	 * Until the end is reached
+	 * Display the current node data
+	 * And move on to the next node
+	 */
+	while (curNode != nullptr) {
+		displayBid(curNode->data);
+		curNode = curNode->next;
+	}
+}
+
+/**
+ * Find the first node with the specified bidId
+ * Through the index when there is one, else by traversal.
+ *
+ * @param bidId The bid id to search for
+ * @return The node, or nullptr if not found
+ */
+LinkedList::BidNode* LinkedList::Find(const string& bidId) {
+	if (indexed) {
+		auto it = index.find(bidId);
+		return it == index.end() ? nullptr : it->second.first;
+	}
+
+	// TRAVERSAL LOGIC WITH A TWIST : We stop on a match rather than display nodes
+	BidNode* curNode = head;
+	while (curNode != nullptr && curNode->data.bidId != bidId)
+		curNode = curNode->next; // Onward to the next node
+
+	return curNode;
+}
+
+/**
+ * Unlink a node and delete it.
+ * O(1): the node knows both of its neighbours.
+ * So removing B means A <-> B <-> C changes links so that the list is A <-> C
+ */
+void LinkedList::Unlink(BidNode* node) {
+	// Removing the head shifts the head one node ahead
+	if (node->prev == nullptr)
+		head = node->next;
+	else
+		node->prev->next = node->next;
+
+	// Removing the tail shifts the tail one node back
+	if (node->next == nullptr)
+		tail = node->prev;
+	else
+		node->next->prev = node->prev;
+
+	// Block nodes stay allocated until the list goes, but drop their data now
+	if (node->inBlock)
+		node->data = Bid();
+	else
+		delete node; // :'(
+
+	--size; // we just deleted a node
+}
+
+/**
+ * Remove a specified bid
+ * Only the first match is removed. Reasonable because bidID can be assumed to be a primary key
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void LinkedList::Remove(string bidId) {
+	BidNode* node = Find(bidId);
+
+	if (node == nullptr)
+		return;
+
+	if (indexed) {
+		indexes.Remove(&node->data);
+
+		IndexEntry& entry = index[bidId];
+
+		// Last node with this ID
+		if (--entry.count == 0) {
+			index.erase(bidId);
+		}
+		// Repeated ID: the next node with it becomes the first one
+		else {
+			BidNode* nextMatch = node->next;
+			while (nextMatch->data.bidId != bidId)
+				nextMatch = nextMatch->next;
+			entry.first = nextMatch;
+		}
+	}
+
+	Unlink(node);
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid LinkedList::Search(string bidId) {
+	BidNode* node = Find(bidId);
+
+	// Return an empty bid or the first match
+	return node ? node->data : Bid();
+}
+
+/**
+ * Find the bids that match a query. In an indexed list an index narrows
+ * the candidates when the query has a fund, amount range or title prefix;
+ * otherwise every node is checked.
+ *
+ * @param query The query to answer
+ * @param plan Receives a description of how the query was answered
+ * @return The matching bids
+ */
+vector<Bid> LinkedList::Query(const BidQuery& query, string* plan) {
+	vector<Bid> matches;
+	vector<const Bid*> candidates;
+	string indexUsed;
+
+	if (indexed && indexes.Candidates(query, candidates, indexUsed)) {
+		if (plan != nullptr)
+			*plan = indexUsed + " index, " + to_string(candidates.size()) + " candidates";
+
+		for (const Bid* bid : candidates) {
+			if (query.Matches(*bid))
+				matches.push_back(*bid);
+		}
+		return matches;
+	}
+
+	if (plan != nullptr)
+		*plan = "full scan";
+
+	for (BidNode* curNode = head; curNode != nullptr; curNode = curNode->next) {
+		if (query.Matches(curNode->data))
+			matches.push_back(curNode->data);
+	}
+	return matches;
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int LinkedList::Size() {
+    return size;
+}
+
+/**
+ * Copy the bids into a vector, in list order
+ */
+vector<Bid> LinkedList::ToVector() {
+	vector<Bid> bids;
+	bids.reserve(size);
+
+	for (BidNode* curNode = head; curNode != nullptr; curNode = curNode->next)
+		bids.push_back(curNode->data);
+
+	return bids;
+}
+
+/**
+ * Sort the list with a stable, bottom-up merge sort.
+ * Nodes are relinked, never copied, and the extra memory is O(1):
+ * runs of 1, 2, 4, ... nodes are merged pairwise until one run is left.
+ *
+ * @param less Comparator on two bids, e.g. by title
+ */
+template <typename Compare>
+void LinkedList::Sort(Compare less) {
+	if (size < 2)
+		return;
+
+	for (int width = 1; width < size; width *= 2) {
+		BidNode* rest = head;
+		BidNode* sortedHead = nullptr, * sortedTail = nullptr;
+
+		// Merge each pair of neighbouring runs and chain the results
+		while (rest != nullptr) {
+			BidNode* left = rest;
+			BidNode* right = Cut(left, width);
+			rest = Cut(right, width);
+
+			BidNode* last;
+			BidNode* merged = MergeRuns(left, right, less, last);
+
+			if (sortedTail == nullptr)
+				sortedHead = merged;
+			else
+				sortedTail->next = merged;
+			sortedTail = last;
+		}
+
+		head = sortedHead;
+	}
+
+	// The merges only maintain the next links
+	RestoreLinks();
+	RefreshIndex();
+}
+
+/**
+ * Merge another sorted list into this sorted one. Stable: on ties,
+ * this list's bids come first. The other list is left empty.
+ *
+ * @param less The comparator both lists are sorted by
+ */
+template <typename Compare>
+void LinkedList::Merge(LinkedList& other, Compare less) {
+	if (this == &other || other.head == nullptr)
+		return;
+
+	BidNode* otherHead = other.head;
+
+	// Take over the nodes, blocks and index entries, then merge the two halves
+	Splice(other);
+
+	if (otherHead == head)
+		return;
+
+	otherHead->prev->next = nullptr;
+
+	BidNode* last;
+	head = MergeRuns(head, otherHead, less, last);
+
+	RestoreLinks();
+	RefreshIndex();
+}
+
+/**
+ * Split a chain after its first 'length' nodes
+ *
+ * @return The rest of the chain (nullptr if it was not longer than that)
+ */
+LinkedList::BidNode* LinkedList::Cut(BidNode* run, int length) {
+	for (int i = 1; run != nullptr && i < length; ++i)
+		run = run->next;
+
+	if (run == nullptr)
+		return nullptr;
+
+	BidNode* rest = run->next;
+	run->next = nullptr;
+	return rest;
+}
+
+/**
+ * Merge two sorted chains by relinking their nodes.
+ * Stable: on ties, the node from the left chain goes first.
+ *
+ * @param last Set to the last node of the merged chain
+ * @return The first node of the merged chain
+ */
+template <typename Compare>
+LinkedList::BidNode* LinkedList::MergeRuns(BidNode* left, BidNode* right, Compare less, BidNode*& last) {
+	BidNode start;
+	BidNode* curNode = &start;
+
+	while (left != nullptr && right != nullptr) {
+		if (less(right->data, left->data)) {
+			curNode->next = right;
+			right = right->next;
+		}
+		else {
+			curNode->next = left;
+			left = left->next;
+		}
+		curNode = curNode->next;
+	}
+
+	// One chain is used up; the other is already in order
+	curNode->next = (left != nullptr) ? left : right;
+	while (curNode->next != nullptr)
+		curNode = curNode->next;
+
+	last = curNode;
+	return start.next;
+}
+
+/**
+ * Rebuild the prev links and the tail from the next links
+ */
+void LinkedList::RestoreLinks() {
+	BidNode* prevNode = nullptr;
+
+	for (BidNode* curNode = head; curNode != nullptr; curNode = curNode->next) {
+		curNode->prev = prevNode;
+		prevNode = curNode;
+	}
+
+	tail = prevNode;
+}
+
+/**
+ * After a reorder, point the index at the new first node of each repeated ID
+ */
+void LinkedList::RefreshIndex() {
+	// Nothing to do without repeated IDs: each entry has a single node
+	if (!indexed || index.size() == (size_t) size)
+		return;
+
+	// Walking backwards, the last assignment per ID is its first node
+	for (BidNode* curNode = tail; curNode != nullptr; curNode = curNode->prev) {
+		IndexEntry& entry = index[curNode->data.bidId];
+		if (entry.count > 1)
+			entry.first = curNode;
+	}
+}
+
+//============================================================================
+// Unrolled Linked-List methods
+//============================================================================
+
+/**
+ * Default constructor
+ */
+UnrolledLinkedList::UnrolledLinkedList() : head { nullptr }, tail { nullptr }, size { 0 } {
+}
+
+/**
+ * Destructor
+ */
+UnrolledLinkedList::~UnrolledLinkedList() {
+	while (head != nullptr) {
+		BidBlock* next = head->next;
+		delete head;
+		head = next;
+	}
+}
+
+/**
+ * Put a bid in the store, reusing a freed slot if there is one
+ *
+ * @return The slot holding the bid
+ */
+unsigned UnrolledLinkedList::Store(Bid& bid) {
+	if (!freeSlots.empty()) {
+		unsigned slot = freeSlots.back();
+		freeSlots.pop_back();
+		store[slot] = move(bid);
+		return slot;
+	}
+
+	store.push_back(move(bid));
+	return store.size() - 1;
+}
+
+/**
+ * Append a new bid to the end of the list
+ * A new node is only needed once the tail node is full.
+ */
+void UnrolledLinkedList::Append(Bid bid) {
+	if (tail == nullptr || tail->count == NODE_CAPACITY) {
+		BidBlock* newBlock = new BidBlock();
+
+		if (head == nullptr)
+			head = tail = newBlock;
+		else {
+			tail->next = newBlock;
+			tail = newBlock;
+		}
+	}
+
+	tail->keys[tail->count] = bid.bidId;
+	tail->slots[tail->count] = Store(bid);
+	++tail->count;
+
+	++size;
+}
+
+/**
+ * Prepend a new bid to the start of the list
+ * Entries in the head node shift up by one; a new node is only needed once it is full.
+ */
+void UnrolledLinkedList::Prepend(Bid bid) {
+	if (head == nullptr || head->count == NODE_CAPACITY) {
+		BidBlock* newBlock = new BidBlock();
+
+		if (head == nullptr)
+			head = tail = newBlock;
+		else {
+			newBlock->next = head;
+			head = newBlock;
+		}
+	}
+
+	// Make room at the front (at most NODE_CAPACITY - 1 moves)
+	for (int i = head->count; i > 0; --i) {
+		head->keys[i] = move(head->keys[i - 1]);
+		head->slots[i] = head->slots[i - 1];
+	}
+
+	head->keys[0] = bid.bidId;
+	head->slots[0] = Store(bid);
+	++head->count;
+
+	++size;
+}
+
+/**
+ * Simple output of all bids in the list
+ */
+void UnrolledLinkedList::PrintList() {
+	for (BidBlock* block = head; block != nullptr; block = block->next)
+		for (int i = 0; i < block->count; ++i)
+			displayBid(store[block->slots[i]]);
+}
+
+/**
+ * Remove a specified bid
+ * Later entries in its node shift down by one; a node left empty is unlinked.
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void UnrolledLinkedList::Remove(string bidId) {
+	BidBlock* prevBlock = nullptr;
+
+	for (BidBlock* block = head; block != nullptr; prevBlock = block, block = block->next) {
+		for (int i = 0; i < block->count; ++i) {
+			if (block->keys[i] != bidId)
+				continue;
+
+			// Free the bid's slot
+			store[block->slots[i]] = Bid();
+			freeSlots.push_back(block->slots[i]);
+
+			// Close the gap
+			for (int j = i + 1; j < block->count; ++j) {
+				block->keys[j - 1] = move(block->keys[j]);
+				block->slots[j - 1] = block->slots[j];
+			}
+			--block->count;
+
+			// Unlink the node if that was its last entry
+			if (block->count == 0) {
+				if (prevBlock == nullptr)
+					head = block->next;
+				else
+					prevBlock->next = block->next;
+
+				if (block == tail)
+					tail = prevBlock;
+
+				delete block;
+			}
+
+			--size;
+
+			// bidId can be assumed to be a primary key
+			return;
+		}
+	}
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid UnrolledLinkedList::Search(string bidId) {
+	for (BidBlock* block = head; block != nullptr; block = block->next)
+		for (int i = 0; i < block->count; ++i)
+			if (block->keys[i] == bidId)
+				return store[block->slots[i]];
+
+	// Return an empty bid
+	return Bid();
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int UnrolledLinkedList::Size() {
+    return size;
+}
+
+//============================================================================
+// Bid Queue class definition
+//============================================================================
+
+/**
+ * A lock-free queue for handing bids from several producer threads to
+ * one consumer thread (Vyukov's multi-producer, single-consumer design).
+ *
+ * Producers link a node in with a single atomic exchange on the tail;
+ * the consumer follows the links from the head and never contends with them.
+ * Nodes are recycled instead of freed: each node returns to the producer
+ * that made it, through a lock-free stack that only the consumer pushes to
+ * and only that producer empties (in one exchange), which avoids ABA.
+ */
+class BidQueue {
+
+public:
+	class Producer;
+
+private:
+
+	// Struct to hold node data
+	struct QueueNode {
+		Bid data;
+
+		// Link to the next node in the queue
+		atomic<QueueNode*> next;
+
+		// Link to the next node while it waits to be reused
+		QueueNode* nextFree;
+
+		// The producer this node is returned to
+		Producer* owner;
+
+		QueueNode(Producer* producer) : next { nullptr }, nextFree { nullptr }, owner { producer } {}
+	};
+
+	// Consumer side: the current dummy node (its data has already been taken)
+	QueueNode* head;
+
+	// Producer side: the last node in the queue
+	atomic<QueueNode*> tail;
+
+	// The first dummy, which belongs to no producer
+	QueueNode stub;
+
+	// Registered producers (only locked when registering)
+	vector<unique_ptr<Producer>> producers;
+	mutex producersLock;
+
+	void Recycle(QueueNode* node);
+
+public:
+
+	/**
+	 * A producer's handle on the queue. Use each one from a single thread.
+	 */
+	class Producer {
+		friend class BidQueue;
+
+		BidQueue* queue;
+
+		// Nodes handed back by the consumer
+		atomic<QueueNode*> returned;
+
+		// Nodes ready for this producer to reuse (not shared)
+		QueueNode* cache;
+
+		Producer(BidQueue* owner) : queue { owner }, returned { nullptr }, cache { nullptr } {}
+
+	public:
+		~Producer();
+		void Push(Bid bid);
+	};
+
+	BidQueue();
+	virtual ~BidQueue();
+
+	// Nodes are owned by the queue, so it cannot be copied
+	BidQueue(const BidQueue&) = delete;
+	BidQueue& operator=(const BidQueue&) = delete;
+
+	// Register a producer. The handle lives as long as the queue.
+	Producer& AddProducer();
+
+	// Take the oldest bid (consumer only). False if the queue looks empty.
+	bool Pop(Bid& bid);
+};
+
+//============================================================================
+// Bid Queue methods
+//============================================================================
+
+/**
+ * Default constructor: an empty queue is a lone dummy node
+ */
+BidQueue::BidQueue() : stub { nullptr } {
+	head = &stub;
+	tail = &stub;
+}
+
+/**
+ * Destructor. No producer or consumer may still be using the queue.
+ */
+BidQueue::~BidQueue() {
+	// The nodes still in the queue (including the current dummy)
+	QueueNode* node = head;
+	while (node != nullptr) {
+		QueueNode* next = node->next.load();
+		if (node != &stub)
+			delete node;
+		node = next;
+	}
+
+	// The producers free the nodes waiting to be reused
+	producers.clear();
+}
+
+/**
+ * Destructor: free the nodes waiting to be reused
+ */
+BidQueue::Producer::~Producer() {
+	for (QueueNode* list : { cache, returned.load() }) {
+		while (list != nullptr) {
+			QueueNode* next = list->nextFree;
+			delete list;
+			list = next;
+		}
+	}
+}
+
+/**
+ * Register a producer
+ */
+BidQueue::Producer& BidQueue::AddProducer() {
+	lock_guard<mutex> lock(producersLock);
+
+	producers.emplace_back(new Producer(this));
+	return *producers.back();
+}
+
+/**
+ * Add a bid to the end of the queue (lock-free)
+ *
+ * @param bid The bid to add. It is moved into the queue.
+ */
+void BidQueue::Producer::Push(Bid bid) {
+	// Refill the private cache with everything the consumer has returned
+	if (cache == nullptr)
+		cache = returned.exchange(nullptr, memory_order_acquire);
+
+	QueueNode* node;
+	if (cache != nullptr) {
+		node = cache;
+		cache = node->nextFree;
+	}
+	else {
+		node = new QueueNode(this);
+	}
+
+	node->data = move(bid);
+	node->next.store(nullptr, memory_order_relaxed);
+
+	// Claim the tail, then link the previous tail to the new node.
+	// Between the two steps the consumer just sees a shorter queue.
+	QueueNode* prev = queue->tail.exchange(node, memory_order_acq_rel);
+	prev->next.store(node, memory_order_release);
+}
+
+/**
+ * Take the oldest bid (consumer only)
+ *
+ * @param bid Set to the bid taken
+ * @return False if the queue is empty (or a push is still being linked in)
+ */
+bool BidQueue::Pop(Bid& bid) {
+	QueueNode* next = head->next.load(memory_order_acquire);
+
+	if (next == nullptr)
+		return false;
+
+	// The node becomes the new dummy once its bid is taken
+	bid = move(next->data);
+
+	QueueNode* oldHead = head;
+	head = next;
+	Recycle(oldHead);
+
+	return true;
+}
+
+/**
+ * Hand a node no longer in the queue back to its producer
+ */
+void BidQueue::Recycle(QueueNode* node) {
+	// The stub is never reused
+	if (node->owner == nullptr)
+		return;
+
+	atomic<QueueNode*>& returned = node->owner->returned;
+
+	QueueNode* top = returned.load(memory_order_relaxed);
+	do {
+		node->nextFree = top;
+	} while (!returned.compare_exchange_weak(top, node, memory_order_release, memory_order_relaxed));
+}
+
+//============================================================================
+// Skip List class definitions
+//============================================================================
+
+/**
+ * A bump allocator for variable-sized nodes.
+ * Memory comes from large chunks and is only given back when the arena goes.
+ * Allocation is lock-free, so concurrent inserts can share an arena.
+ */
+class NodeArena {
+
+private:
+	static const size_t CHUNK_BYTES = 1 << 16;
+
+	// Chunk header. The usable bytes follow it.
+	struct Chunk {
+		Chunk* prev;
+		size_t capacity;
+		atomic<size_t> used;
+	};
+
+	// Header size, rounded up so the bytes after it are suitably aligned
+	static const size_t HEADER_BYTES = (sizeof(Chunk) + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+	// The chunk being carved up (earlier ones are chained through prev)
+	atomic<Chunk*> current;
+
+public:
+	NodeArena() : current { nullptr } {}
+	~NodeArena();
+
+	NodeArena(const NodeArena&) = delete;
+	NodeArena& operator=(const NodeArena&) = delete;
+
+	void* Allocate(size_t bytes);
+};
+
+/**
+ * A skip list of bids ordered by bidId.
+ * Each node is on level 0 and, with the given probability, on each next
+ * level up as well, so searches skip ahead on the sparse upper levels:
+ * Search, Insert and Remove take expected O(log n), and level 0 is an
+ * ordered list for cheap forward scans. Nodes come from a NodeArena and
+ * removed nodes are reused by later inserts of the same height.
+ *
+ * As an ordered set, Append and Prepend both insert in bidId order,
+ * and a bidId that is already present is ignored.
+ */
+class SkipList : public BidList {
+
+private:
+	static const int MAX_LEVEL = 24;
+
+	// Struct to hold node data
+	struct SkipNode {
+		Bid data;
+		int height;
+
+		// The node is followed in memory by 'height' forward links
+		SkipNode** Next() { return reinterpret_cast<SkipNode**>(this + 1); }
+	};
+
+	// Sentinel before the first node, with links on every level
+	SkipNode* head;
+	int level;
+	int size;
+
+	// Chance that a node on one level is also on the next
+	double probability;
+	mt19937 rng;
+	uniform_real_distribution<double> coin;
+
+	NodeArena arena;
+
+	// Removed nodes ready for reuse, by height
+	vector<SkipNode*> freeNodes[MAX_LEVEL + 1];
+
+	int RandomHeight();
+	SkipNode* NewNode(int height);
+	SkipNode* FindPreds(const string& bidId, SkipNode** preds);
+
+public:
+	SkipList(double levelProbability = 0.25);
+	virtual ~SkipList();
+
+	SkipList(const SkipList&) = delete;
+	SkipList& operator=(const SkipList&) = delete;
+
+	bool Insert(Bid bid);
+	void Append(Bid bid) { Insert(move(bid)); }
+	void Prepend(Bid bid) { Insert(move(bid)); }
+	void PrintList();
+	void Remove(string bidId);
+	Bid Search(string bidId);
+	int Size();
+};
+
+/**
+ * A lock-free skip list of bids ordered by bidId, for inserting from several threads.
+ * Nodes are linked in with compare-and-swap, level 0 first (which is
+ * where an insert takes effect) and then the levels above. Removal is
+ * logical: a node is marked removed and skipped from then on, and a bidId
+ * can be inserted again after it was removed. Nodes are only freed, with
+ * the arena, when the list is destroyed.
+ */
+class ConcurrentSkipList : public BidList {
+
+private:
+	static const int MAX_LEVEL = 24;
+
+	// Struct to hold node data
+	struct SkipNode {
+		Bid data;
+		int height;
+		atomic<bool> removed;
+
+		// The node is followed in memory by 'height' forward links
+		atomic<SkipNode*>* Next() { return reinterpret_cast<atomic<SkipNode*>*>(this + 1); }
+	};
+
+	SkipNode* head;
+	atomic<int> size;
+	double probability;
+
+	NodeArena arena;
+
+	int RandomHeight();
+	SkipNode* NewNode(int height);
+	void FindPreds(const string& bidId, SkipNode** preds, SkipNode** succs);
+	SkipNode* FindLive(const string& bidId);
+
+public:
+	ConcurrentSkipList(double levelProbability = 0.25);
+	virtual ~ConcurrentSkipList();
+
+	ConcurrentSkipList(const ConcurrentSkipList&) = delete;
+	ConcurrentSkipList& operator=(const ConcurrentSkipList&) = delete;
+
+	bool Insert(Bid bid);
+	void Append(Bid bid) { Insert(move(bid)); }
+	void Prepend(Bid bid) { Insert(move(bid)); }
+	void PrintList();
+	void Remove(string bidId);
+	Bid Search(string bidId);
+	int Size();
+};
+
+//============================================================================
+// Skip List methods
+//============================================================================
+
+/**
+ * Destructor: free every chunk
+ */
+NodeArena::~NodeArena() {
+	Chunk* chunk = current.load();
+	while (chunk != nullptr) {
+		Chunk* prev = chunk->prev;
+		chunk->~Chunk();
+		operator delete(chunk);
+		chunk = prev;
+	}
+}
+
+/**
+ * Take some bytes from the arena (lock-free)
+ *
+ * @param bytes Size of the allocation
+ * @return Memory aligned for any type
+ */
+void* NodeArena::Allocate(size_t bytes) {
+	// Keep every allocation aligned
+	bytes = (bytes + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+
+	while (true) {
+		Chunk* chunk = current.load(memory_order_acquire);
+
+		if (chunk != nullptr) {
+			size_t offset = chunk->used.fetch_add(bytes, memory_order_relaxed);
+			if (offset + bytes <= chunk->capacity)
+				return reinterpret_cast<char*>(chunk) + HEADER_BYTES + offset;
+		}
+
+		// Full (or no chunk yet): try to install a new one. If another thread got there first, use theirs
+		size_t capacity = bytes > CHUNK_BYTES ? bytes : CHUNK_BYTES;
+		Chunk* fresh = new (operator new(HEADER_BYTES + capacity)) Chunk();
+		fresh->prev = chunk;
+		fresh->capacity = capacity;
+		fresh->used = 0;
+
+		if (!current.compare_exchange_strong(chunk, fresh, memory_order_acq_rel)) {
+			fresh->~Chunk();
+			operator delete(fresh);
+		}
+	}
+}
+
+/**
+ * Constructor
+ *
+ * @param levelProbability Chance that a node on one level is also on the next
+ */
+SkipList::SkipList(double levelProbability) : level { 1 }, size { 0 }, probability { levelProbability }, coin { 0.0, 1.0 } {
+	head = NewNode(MAX_LEVEL);
+}
+
+/**
+ * Destructor: the arena frees the memory, but each bid must be destroyed first
+ */
+SkipList::~SkipList() {
+	SkipNode* node = head;
+	while (node != nullptr) {
+		SkipNode* next = node->Next()[0];
+		node->~SkipNode();
+		node = next;
+	}
+
+	for (vector<SkipNode*>& nodes : freeNodes)
+		for (SkipNode* free : nodes)
+			free->~SkipNode();
+}
+
+/**
+ * Pick a height for a new node: 1, then one more level each time the coin comes up
+ */
+int SkipList::RandomHeight() {
+	int height = 1;
+	while (height < MAX_LEVEL && coin(rng) < probability)
+		++height;
+	return height;
+}
+
+/**
+ * Get a node of the given height, reusing a removed one if possible
+ */
+SkipList::SkipNode* SkipList::NewNode(int height) {
+	SkipNode* node;
+
+	if (!freeNodes[height].empty()) {
+		node = freeNodes[height].back();
+		freeNodes[height].pop_back();
+	}
+	else {
+		node = new (arena.Allocate(sizeof(SkipNode) + height * sizeof(SkipNode*))) SkipNode();
+		node->height = height;
+	}
+
+	for (int i = 0; i < height; ++i)
+		node->Next()[i] = nullptr;
+
+	return node;
+}
+
+/**
+ * Find the last node before bidId on every level
+ *
+ * @param preds Filled with the predecessor on each level
+ * @return The first node at or after bidId on level 0
+ */
+SkipList::SkipNode* SkipList::FindPreds(const string& bidId, SkipNode** preds) {
+	SkipNode* node = head;
+
+	// Run along each level as far as possible, then drop down
+	for (int i = level - 1; i >= 0; --i) {
+		while (node->Next()[i] != nullptr && node->Next()[i]->data.bidId < bidId)
+			node = node->Next()[i];
+		preds[i] = node;
+	}
+
+	return node->Next()[0];
+}
+
+/**
+ * Insert a bid in bidId order
+ *
+ * @return False if the bidId was already present
+ */
+bool SkipList::Insert(Bid bid) {
+	SkipNode* preds[MAX_LEVEL];
+	SkipNode* next = FindPreds(bid.bidId, preds);
+
+	if (next != nullptr && next->data.bidId == bid.bidId)
+		return false;
+
+	int height = RandomHeight();
+
+	// New levels start from the head
+	for (int i = level; i < height; ++i)
+		preds[i] = head;
+	level = max(level, height);
+
+	SkipNode* node = NewNode(height);
+	node->data = move(bid);
+
+	for (int i = 0; i < height; ++i) {
+		node->Next()[i] = preds[i]->Next()[i];
+		preds[i]->Next()[i] = node;
+	}
+
+	++size;
+	return true;
+}
+
+/**
+ * Remove a specified bid
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void SkipList::Remove(string bidId) {
+	SkipNode* preds[MAX_LEVEL];
+	SkipNode* node = FindPreds(bidId, preds);
+
+	if (node == nullptr || node->data.bidId != bidId)
+		return;
+
+	// Unlink it from every level it is on
+	for (int i = 0; i < node->height; ++i)
+		preds[i]->Next()[i] = node->Next()[i];
+
+	// Drop levels that are now empty
+	while (level > 1 && head->Next()[level - 1] == nullptr)
+		--level;
+
+	node->data = Bid();
+	freeNodes[node->height].push_back(node);
+
+	--size;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid SkipList::Search(string bidId) {
+	SkipNode* preds[MAX_LEVEL];
+	SkipNode* node = FindPreds(bidId, preds);
+
+	if (node != nullptr && node->data.bidId == bidId)
+		return node->data;
+
+	return Bid();
+}
+
+/**
+ * Output of all bids in bidId order (a level 0 scan)
+ */
+void SkipList::PrintList() {
+	for (SkipNode* node = head->Next()[0]; node != nullptr; node = node->Next()[0])
+		displayBid(node->data);
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int SkipList::Size() {
+	return size;
+}
+
+/**
+ * Constructor
+ *
+ * @param levelProbability Chance that a node on one level is also on the next
+ */
+ConcurrentSkipList::ConcurrentSkipList(double levelProbability) : size { 0 }, probability { levelProbability } {
+	head = NewNode(MAX_LEVEL);
+}
+
+/**
+ * Destructor (no other thread may be using the list)
+ */
+ConcurrentSkipList::~ConcurrentSkipList() {
+	SkipNode* node = head;
+	while (node != nullptr) {
+		SkipNode* next = node->Next()[0].load();
+		node->~SkipNode();
+		node = next;
+	}
+}
+
+/**
+ * Pick a height for a new node, with a random generator per thread
+ */
+int ConcurrentSkipList::RandomHeight() {
+	thread_local mt19937 rng(hash<thread::id>()(this_thread::get_id()));
+	uniform_real_distribution<double> coin(0.0, 1.0);
+
+	int height = 1;
+	while (height < MAX_LEVEL && coin(rng) < probability)
+		++height;
+	return height;
+}
+
+/**
+ * Make an unlinked node of the given height in the arena
+ */
+ConcurrentSkipList::SkipNode* ConcurrentSkipList::NewNode(int height) {
+	void* memory = arena.Allocate(sizeof(SkipNode) + height * sizeof(atomic<SkipNode*>));
+
+	SkipNode* node = new (memory) SkipNode();
+	node->height = height;
+	node->removed = false;
+
+	for (int i = 0; i < height; ++i)
+		new (&node->Next()[i]) atomic<SkipNode*>(nullptr);
+
+	return node;
+}
+
+/**
+ * Find, on every level, the last node before bidId and the one after it
+ * (the first node with an ID at or after bidId)
+ */
+void ConcurrentSkipList::FindPreds(const string& bidId, SkipNode** preds, SkipNode** succs) {
+	SkipNode* node = head;
+
+	for (int i = MAX_LEVEL - 1; i >= 0; --i) {
+		SkipNode* next = node->Next()[i].load(memory_order_acquire);
+		while (next != nullptr && next->data.bidId < bidId) {
+			node = next;
+			next = node->Next()[i].load(memory_order_acquire);
+		}
+		preds[i] = node;
+		succs[i] = next;
+	}
+}
+
+/**
+ * Find the node for a bidId that has not been removed
+ * (removed nodes with the same ID may sit next to it)
+ */
+ConcurrentSkipList::SkipNode* ConcurrentSkipList::FindLive(const string& bidId) {
+	SkipNode* node = head;
+
+	for (int i = MAX_LEVEL - 1; i >= 0; --i) {
+		SkipNode* next = node->Next()[i].load(memory_order_acquire);
+		while (next != nullptr && next->data.bidId < bidId) {
+			node = next;
+			next = node->Next()[i].load(memory_order_acquire);
+		}
+	}
+
+	for (node = node->Next()[0].load(memory_order_acquire);
+			node != nullptr && node->data.bidId == bidId;
+			node = node->Next()[0].load(memory_order_acquire)) {
+		if (!node->removed.load(memory_order_acquire))
+			return node;
+	}
+
+	return nullptr;
+}
+
+/**
+ * Insert a bid in bidId order (lock-free)
+ *
+ * @return False if the bidId was already present
+ */
+bool ConcurrentSkipList::Insert(Bid bid) {
+	// Cheap early out before allocating
+	if (FindLive(bid.bidId) != nullptr)
+		return false;
+
+	SkipNode* preds[MAX_LEVEL];
+	SkipNode* succs[MAX_LEVEL];
+
+	int height = RandomHeight();
+	SkipNode* node = NewNode(height);
+	node->data = move(bid);
+	const string& bidId = node->data.bidId;
+
+	// Level 0: the insert takes effect when this CAS succeeds
+	while (true) {
+		FindPreds(bidId, preds, succs);
+
+		/* Give up if a live node with this ID exists. Any node with this ID
+		 * linked after this check would change preds[0]'s link and fail the CAS
+		 */
+		bool present = false;
+		for (SkipNode* same = succs[0]; same != nullptr && same->data.bidId == bidId;
+				same = same->Next()[0].load(memory_order_acquire)) {
+			if (!same->removed.load(memory_order_acquire)) {
+				present = true;
+				break;
+			}
+		}
+		if (present) {
+			// Its memory stays in the arena
+			node->~SkipNode();
+			return false;
+		}
+
+		for (int i = 0; i < height; ++i)
+			node->Next()[i].store(succs[i], memory_order_relaxed);
+
+		// Publishes the node (and its bid) to readers
+		if (preds[0]->Next()[0].compare_exchange_strong(succs[0], node, memory_order_release, memory_order_relaxed))
+			break;
+	}
+
+	++size;
+
+	// The upper levels only speed up searches, so they can follow
+	for (int i = 1; i < height; ++i) {
+		while (true) {
+			if (preds[i]->Next()[i].compare_exchange_strong(succs[i], node, memory_order_release, memory_order_relaxed))
+				break;
+
+			// Lost a race on this level: look again
+			FindPreds(bidId, preds, succs);
+			node->Next()[i].store(succs[i], memory_order_relaxed);
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Remove a specified bid by marking its node (lock-free)
+ *
+ * @param bidId The bid id to remove from the list
+ */
+void ConcurrentSkipList::Remove(string bidId) {
+	SkipNode* node = FindLive(bidId);
+	bool expected = false;
+
+	// Only one remover can win the mark
+	if (node != nullptr && node->removed.compare_exchange_strong(expected, true, memory_order_acq_rel))
+		--size;
+}
+
+/**
+ * Search for the specified bidId
+ *
+ * @param bidId The bid id to search for
+ */
+Bid ConcurrentSkipList::Search(string bidId) {
+	SkipNode* node = FindLive(bidId);
+	return node != nullptr ? node->data : Bid();
+}
+
+/**
+ * Output of all bids in bidId order (a level 0 scan)
+ */
+void ConcurrentSkipList::PrintList() {
+	for (SkipNode* node = head->Next()[0].load(memory_order_acquire); node != nullptr;
+			node = node->Next()[0].load(memory_order_acquire)) {
+		if (!node->removed.load(memory_order_acquire))
+			displayBid(node->data);
+	}
+}
+
+/**
+ * Returns the current size (number of elements) in the list
+ */
+int ConcurrentSkipList::Size() {
+	return size;
+}
+
+//============================================================================
+// Lookup cache definitions
+//============================================================================
+
+// Default number of bids the lookup cache holds
+const size_t DEFAULT_CACHE_CAPACITY = 1024;
+
+/**
+ * A bounded, sharded CLOCK cache of bids by bidId. Here it spares
+ * repeated lookups the list's O(n) scan (see CachedBidList).
+ * (Copied from BinarySearchTree)
+ */
+class LookupCache {
+
+private:
+	struct Entry {
+		string key;
+		Bid bid;
+
+		// Set by hits, cleared by the sweeping hand
+		atomic<bool> referenced { false };
+
+		bool used = false;
+	};
 
-private:
+	struct Shard {
+		// Shared for hits, exclusive for changes
+		shared_mutex lock;
 
-	// Struct to hold node data
-	struct BidNode {
-		Bid data;
-		BidNode* next;
+		vector<Entry> entries;
+		unordered_map<string, size_t> slots;
+		size_t hand = 0;
+		uint64_t epoch = 0;
 
-		// default ctor
-		BidNode() {
-			next = nullptr;
-		}
+		atomic<size_t> hits { 0 };
+		atomic<size_t> misses { 0 };
+		atomic<size_t> evictions { 0 };
 
-		// parameterised ctor
-		BidNode(Bid bid) {
-			data = bid;
-			next = nullptr;
-		}
+		explicit Shard(size_t capacity) : entries(capacity) {}
 	};
 
-	/* HOUSEKEEPING VARIABLES
-	 * Pointers to the head & tail
-	 * An int to store the size (this makes the retrieval of the size O(1) instead of O(n) in a calculation by traversal)
-	 */
-	BidNode* head, * tail;
-	int size;
+	vector<unique_ptr<Shard>> shards;
+	size_t capacity;
+
+	Shard& ShardFor(const string& key);
 
 public:
-    LinkedList();
-    virtual ~LinkedList();
-    void Append(Bid bid);
-    void Prepend(Bid bid);
-    void PrintList();
-    void Remove(string bidId);
-    Bid Search(string bidId);
-    int Size();
+	// A cache of (at least) capacity bids split over shardCount shards
+	explicit LookupCache(size_t capacity = DEFAULT_CACHE_CAPACITY, unsigned shardCount = 1);
+
+	// Look up a bid; on a miss, epoch receives the value to pass to Put
+	bool Get(const string& key, Bid& bid, uint64_t& epoch);
+
+	// Cache a bid found after a miss that returned epoch
+	void Put(const string& key, const Bid& bid, uint64_t epoch);
+
+	// Drop any cached copy of a bid
+	void Erase(const string& key);
+
+	// Drop everything (the counters are kept)
+	void Clear();
+
+	size_t Hits() const;
+	size_t Misses() const;
+	size_t Evictions() const;
+	double HitRate() const;
+
+	size_t Capacity() const { return capacity; }
+	unsigned ShardCount() const { return shards.size(); }
 };
 
 /**
- * Default constructor
+ * A list with a lookup cache in front of its searches.
+ * Wraps any of the list modes: their searches stay O(n) (or O(log n)),
+ * but repeated lookups of the same bids are answered by the cache.
+ * Changes go to the list first and then invalidate the cached copy;
+ * a bulk append drops the whole cache.
  */
-LinkedList::LinkedList() : head { nullptr }, tail { nullptr }, size { 0 } { // Initialisations in an initialiser list
-}
+class CachedBidList : public BidList {
+
+private:
+	// The wrapped list, owned by this one
+	BidList* list;
+
+	LookupCache cache;
+
+public:
+	CachedBidList(BidList* inner, size_t capacity = DEFAULT_CACHE_CAPACITY, unsigned shardCount = 1)
+		: list { inner }, cache { capacity, shardCount } {}
+	virtual ~CachedBidList() { delete list; }
+
+	CachedBidList(const CachedBidList&) = delete;
+	CachedBidList& operator=(const CachedBidList&) = delete;
+
+	void Append(Bid bid);
+	void Prepend(Bid bid);
+	void PrintList() { list->PrintList(); }
+	void Remove(string bidId);
+	Bid Search(string bidId);
+	int Size() { return list->Size(); }
+	void AppendRange(vector<Bid>& bids);
+
+	// Forget every cached bid, e.g. after the list is reordered
+	void Invalidate() { cache.Clear(); }
+
+	BidList* Inner() { return list; }
+	const LookupCache& Cache() const { return cache; }
+};
+
+//============================================================================
+// Lookup cache methods
+//============================================================================
 
 /**
- * Destructor
+ * Constructor. The capacity is spread evenly over the shards.
+ *
+ * @param capacity Number of bids to hold
+ * @param shardCount Number of independently locked shards (1 for one thread)
  */
-LinkedList::~LinkedList() {
+LookupCache::LookupCache(size_t capacity, unsigned shardCount) {
+	shardCount = max(shardCount, 1u);
+	size_t perShard = max<size_t>((capacity + shardCount - 1) / shardCount, 1);
+
+	for (unsigned s = 0; s < shardCount; ++s) {
+		shards.emplace_back(new Shard(perShard));
+	}
+	this->capacity = perShard * shardCount;
 }
 
 /**
- * Append a new bid to the end of the list
+ * The shard a key belongs to
  */
-void LinkedList::Append(Bid bid) {
-	BidNode* newNode = new BidNode(bid); // new data node
-
-	// The first element is both the head & the tail
-	if (head == nullptr) {
-		head = tail = newNode;
-	}
+LookupCache::Shard& LookupCache::ShardFor(const string& key) {
+	return *shards[hash<string>()(key) % shards.size()];
+}
 
-	// Else, add the new element after the tail and make it the new tail
-	else {
-		tail->next = newNode;
-		tail = newNode;
+/**
+ * Look up a bid. A hit only marks the entry as referenced.
+ *
+ * @param key The bidId
+ * @param bid Receives the cached bid on a hit
+ * @param epoch Receives the shard's epoch on a miss
+ * @return true on a hit
+ */
+bool LookupCache::Get(const string& key, Bid& bid, uint64_t& epoch) {
+	Shard& shard = ShardFor(key);
+	shared_lock<shared_mutex> lock(shard.lock);
+
+	auto found = shard.slots.find(key);
+	if (found == shard.slots.end()) {
+		epoch = shard.epoch;
+		shard.misses.fetch_add(1, memory_order_relaxed);
+		return false;
 	}
 
-	++size; // We just added a node
+	Entry& entry = shard.entries[found->second];
+	entry.referenced.store(true, memory_order_relaxed);
+	bid = entry.bid;
+	shard.hits.fetch_add(1, memory_order_relaxed);
+	return true;
 }
 
 /**
- * Prepend a new bid to the start of the list
+ * Cache a bid, evicting the first unreferenced entry under the hand if
+ * the shard is full. Dropped if the key's shard has seen an Erase since
+ * the miss, as the bid may already be out of date.
+ *
+ * @param key The bidId
+ * @param bid The bid read from the container
+ * @param epoch The epoch returned by the missing Get
  */
-void LinkedList::Prepend(Bid bid) {
-	BidNode* newNode = new BidNode(bid); // new data node
+void LookupCache::Put(const string& key, const Bid& bid, uint64_t epoch) {
+	Shard& shard = ShardFor(key);
+	unique_lock<shared_mutex> lock(shard.lock);
 
-	// The first element is both the head & the tail
-	if (head == nullptr) {
-		head = tail = newNode;
+	if (shard.epoch != epoch) {
+		return;
 	}
 
-	// Else, add the new element before the head and make it the new head
-	else {
-		newNode->next = head;
-		head = newNode;
+	// Another thread missed on the same key and got here first
+	auto found = shard.slots.find(key);
+	if (found != shard.slots.end()) {
+		shard.entries[found->second].bid = bid;
+		return;
 	}
 
-	++size; // We just added a node
+	// Sweep: referenced entries get a second chance, the first other one goes
+	size_t ringSize = shard.entries.size();
+	while (shard.entries[shard.hand].used) {
+		Entry& entry = shard.entries[shard.hand];
+		if (!entry.referenced.exchange(false, memory_order_relaxed)) {
+			shard.slots.erase(entry.key);
+			entry.used = false;
+			shard.evictions.fetch_add(1, memory_order_relaxed);
+			break;
+		}
+		shard.hand = (shard.hand + 1) % ringSize;
+	}
+
+	// New entries start unreferenced, so one-off lookups are evicted first
+	Entry& entry = shard.entries[shard.hand];
+	entry.key = key;
+	entry.bid = bid;
+	entry.referenced.store(false, memory_order_relaxed);
+	entry.used = true;
+	shard.slots[key] = shard.hand;
+	shard.hand = (shard.hand + 1) % ringSize;
 }
 
 /**
- * Simple output of all bids in the list
+ * Drop any cached copy of a bid and start a new epoch for its shard
+ *
+ * @param key The bidId
  */
-void LinkedList::PrintList() {
-	// Start at the head
-	BidNode* curNode = head;
-
-	/* TRAVERSAL LOGIC
-	 * Until the end is reached
-	 * Display the current node data
-	 * And move on to the next node
-	 */
-	while (curNode != nullptr) {
-		displayBid(curNode->data);
-		curNode = curNode->next;
+void LookupCache::Erase(const string& key) {
+	Shard& shard = ShardFor(key);
+	unique_lock<shared_mutex> lock(shard.lock);
+
+	++shard.epoch;
+
+	auto found = shard.slots.find(key);
+	if (found != shard.slots.end()) {
+		Entry& entry = shard.entries[found->second];
+		entry.key.clear();
+		entry.bid = Bid();
+		entry.used = false;
+		shard.slots.erase(found);
 	}
 }
 
 /**
- * Remove a specified bid
- *
- * @param bidId The bid id to remove from the list
+ * Drop every cached bid
  */
-void LinkedList::Remove(string bidId) {
-
-	// Trackers: Current node (start at head), previous node (need the latter for the last else block)
-	BidNode* curNode, * prevNode;
-	curNode = prevNode = head;
-
-	while (curNode != nullptr) {
-
-		// On finding a match
-		if (curNode->data.bidId == bidId) {
-
-			// Removing the head
-			if (curNode == head) {
-
-				// Shift the head one node ahead
-				BidNode* sucNode = head->next;
-				head = sucNode;
-
-				// If we just deleted the last element, the tail should be nullptr too
-				if (sucNode == nullptr)
-					tail = nullptr;
-			}
-
-			/* REMOVING ANY OTHER NODE
-			 * Link the previous node to the next one.
-			 * So removing B means A -> B -> C changes links so that the list is A -> C
-			 */
-			else {
-				prevNode->next = curNode->next;
-				delete curNode; // :'(
-			}
+void LookupCache::Clear() {
+	for (auto& shard : shards) {
+		unique_lock<shared_mutex> lock(shard->lock);
+
+		++shard->epoch;
+		for (Entry& entry : shard->entries) {
+			entry.key.clear();
+			entry.bid = Bid();
+			entry.referenced.store(false, memory_order_relaxed);
+			entry.used = false;
+		}
+		shard->slots.clear();
+		shard->hand = 0;
+	}
+}
 
-			--size; // we just deleted a node
+size_t LookupCache::Hits() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->hits.load(memory_order_relaxed);
+	}
+	return total;
+}
 
-			// break on first deletion. Reasonable because bidID can be assumed to be a primary key
-			break;
-		}
+size_t LookupCache::Misses() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->misses.load(memory_order_relaxed);
+	}
+	return total;
+}
 
-		prevNode = curNode; // track the last node
-		curNode = curNode->next; // move on to the next node
+size_t LookupCache::Evictions() const {
+	size_t total = 0;
+	for (const auto& shard : shards) {
+		total += shard->evictions.load(memory_order_relaxed);
 	}
+	return total;
 }
 
 /**
- * Search for the specified bidId
- *
- * @param bidId The bid id to search for
+ * Share of lookups answered from the cache
  */
-Bid LinkedList::Search(string bidId) {
-	BidNode* curNode = head;
-	Bid result;
+double LookupCache::HitRate() const {
+	size_t hits = Hits();
+	size_t lookups = hits + Misses();
+	return lookups == 0 ? 0.0 : hits * 1.0 / lookups;
+}
 
-	// TRAVERSAL LOGIC WITH A TWIST : We set the result on a match rather than display nodes
-	while (curNode != nullptr) {
+/**
+ * Append a bid, then drop any cached bid with its ID
+ */
+void CachedBidList::Append(Bid bid) {
+	string bidId = bid.bidId;
+	list->Append(move(bid));
+	cache.Erase(bidId);
+}
 
-		// On match
-		if (curNode->data.bidId == bidId) {
-			// Set the result
-			result = curNode->data;
+/**
+ * Prepend a bid, then drop any cached bid with its ID
+ * (it may now be the one a search finds first)
+ */
+void CachedBidList::Prepend(Bid bid) {
+	string bidId = bid.bidId;
+	list->Prepend(move(bid));
+	cache.Erase(bidId);
+}
 
-			// Break on the first match. Reasonable because bidID can be assumed to be a primary key
-			break;
-		}
-		curNode = curNode->next; // Onward to the next node
-	}
+/**
+ * Append a batch of bids. The cache is cleared once rather than per bid.
+ */
+void CachedBidList::AppendRange(vector<Bid>& bids) {
+	list->AppendRange(bids);
+	cache.Clear();
+}
 
-	// Return an empty bid or the first match
-	return result;
+/**
+ * Remove a bid from the list and the cache
+ */
+void CachedBidList::Remove(string bidId) {
+	list->Remove(bidId);
+	cache.Erase(bidId);
 }
 
 /**
- * Returns the current size (number of elements) in the list
+ * Search the cache, then the list. Only bids that were found are cached.
  */
-int LinkedList::Size() {
-    return size;
+Bid CachedBidList::Search(string bidId) {
+	Bid bid;
+	uint64_t epoch;
+	if (cache.Get(bidId, bid, epoch)) {
+		return bid;
+	}
+
+	bid = list->Search(bidId);
+	if (!bid.bidId.empty()) {
+		cache.Put(bidId, bid, epoch);
+	}
+	return bid;
 }
 
 //============================================================================
@@ -269,17 +2262,158 @@ Bid getBid() {
     return bid;
 }
 
+/**
+ * Prompt for a query using console (std::in); blank answers match anything
+ *
+ * @return the query entered
+ */
+BidQuery getBidQuery() {
+	BidQuery query;
+	string line;
+
+	cin.ignore();
+	cout << "Fund (blank for any): ";
+	getline(cin, query.fund);
+
+	cout << "Title starts with (blank for any): ";
+	getline(cin, query.titlePrefix);
+
+	cout << "Title contains (blank for any): ";
+	getline(cin, query.titleContains);
+
+	cout << "Minimum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.minAmount = strToDouble(line, '$');
+	}
+
+	cout << "Maximum amount (blank for none): ";
+	getline(cin, line);
+	if (!line.empty()) {
+		query.maxAmount = strToDouble(line, '$');
+	}
+
+	return query;
+}
+
+/**
+ * Partition the vector of bids into two parts, low and high
+ * (Copied from VectorSorting for the sort comparison)
+ *
+ * @param bids Address of the vector<Bid> instance to be partitioned
+ * @param begin Beginning index to partition
+ * @param end Ending index to partition
+ */
+int partition(vector<Bid>& bids, int begin, int end) {
+	// Pick the middle value as the pivot (Hoare scheme)
+	string pivotVal = bids[(begin + end) / 2].title;
+
+	int low  = begin - 1;
+	int high =  end  + 1;
+
+	while (true) {
+		do {
+			++low;
+		} while (bids[low].title < pivotVal);
+
+		do {
+			--high;
+		} while (bids[high].title > pivotVal);
+
+		if (low >= high) {
+			return high;
+		}
+
+		swap(bids[low], bids[high]);
+	}
+}
+
+/**
+ * Perform a quick sort on bid title
+ * (Copied from VectorSorting for the sort comparison)
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on
+ */
+void quickSort(vector<Bid>& bids, int begin, int end) {
+	if (begin < end) {
+		int p = partition(bids, begin, end);
+		quickSort(bids, begin, p);
+		quickSort(bids, p + 1, end);
+	}
+}
+
+/**
+ * Sort a linked list by title, timed against copying it into a vector and quick sorting that
+ *
+ * @param list The list to sort
+ */
+void sortByTitle(LinkedList* list) {
+	clock_t ticks;
+
+	// The alternative: copy out and sort the copy
+	ticks = clock();
+
+	vector<Bid> bids = list->ToVector();
+	quickSort(bids, 0, (int) bids.size() - 1);
+
+	ticks = clock() - ticks;
+	cout << "copy + quickSort: " << ticks << " clock ticks, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+	// Sorting the list itself
+	ticks = clock();
+
+	list->Sort([](const Bid& a, const Bid& b) { return a.title < b.title; });
+
+	ticks = clock() - ticks;
+	cout << "list merge sort:  " << ticks << " clock ticks, " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+}
+
+/**
+ * Names of the list implementations, in the order used by makeList
+ */
+const char* LIST_MODES[] = { "linked list", "hash-indexed linked list", "unrolled linked list",
+                             "skip list", "concurrent skip list", "cached linked list" };
+const int LIST_MODE_COUNT = sizeof(LIST_MODES) / sizeof(LIST_MODES[0]);
+
+/**
+ * Create an empty list of the given kind
+ *
+ * @param mode Index into LIST_MODES
+ */
+BidList* makeList(int mode) {
+    switch (mode) {
+    case 1:
+        return new LinkedList(true);
+    case 2:
+        return new UnrolledLinkedList();
+    case 3:
+        return new SkipList();
+    case 4:
+        return new ConcurrentSkipList();
+    case 5:
+        return new CachedBidList(new LinkedList());
+    default:
+        return new LinkedList();
+    }
+}
+
 /**
  * Load a CSV file containing bids into a LinkedList
  *
  * @return a LinkedList containing all the bids read
  */
-void loadBids(string csvPath, LinkedList *list) {
+void loadBids(string csvPath, BidList *list) {
     cout << "Loading CSV file " << csvPath << endl;
 
     // initialize the CSV Parser
     csv::Parser file = csv::Parser(csvPath);
 
+    // Collected first so the list can take them in one batch
+    vector<Bid> bids;
+    bids.reserve(file.rowCount());
+
     try {
         // loop to read rows of a CSV file
         for (unsigned i = 0; i < file.rowCount(); i++) {
@@ -294,11 +2428,101 @@ void loadBids(string csvPath, LinkedList *list) {
             //cout << bid.bidId << ": " << bid.title << " | " << bid.fund << " | " << bid.amount << endl;
 
             // add this bid to the end
-            list->Append(bid);
+            bids.push_back(move(bid));
         }
     } catch (csv::Error &e) {
         std::cerr << e.what() << std::endl;
     }
+
+    list->AppendRange(bids);
+}
+
+/**
+ * Load a CSV file into a list, converting the rows on several threads.
+ * The converter threads feed a BidQueue and this thread drains it into the list,
+ * so bids arrive in no particular order.
+ * A concurrent skip list takes the bids straight from the converter threads.
+ *
+ * @param threads Number of converter threads
+ */
+void loadBidsParallel(string csvPath, BidList *list, unsigned threads) {
+    cout << "Loading CSV file " << csvPath << " on " << threads << " threads" << endl;
+
+    // initialize the CSV Parser
+    csv::Parser file = csv::Parser(csvPath);
+
+    if (ConcurrentSkipList* skipList = dynamic_cast<ConcurrentSkipList*>(list)) {
+        vector<thread> inserters;
+
+        for (unsigned t = 0; t < threads; ++t) {
+            inserters.emplace_back([&file, skipList, t, threads]() {
+                try {
+                    for (unsigned i = t; i < file.rowCount(); i += threads) {
+                        Bid bid;
+                        bid.bidId = file[i][1];
+                        bid.title = file[i][0];
+                        bid.fund = file[i][8];
+                        bid.amount = strToDouble(file[i][4], '$');
+
+                        skipList->Insert(move(bid));
+                    }
+                } catch (csv::Error &e) {
+                    std::cerr << e.what() << std::endl;
+                }
+            });
+        }
+
+        for (thread& inserter : inserters)
+            inserter.join();
+
+        return;
+    }
+
+    BidQueue queue;
+    atomic<unsigned> running { threads };
+    vector<thread> converters;
+
+    for (unsigned t = 0; t < threads; ++t) {
+        BidQueue::Producer& producer = queue.AddProducer();
+
+        // Each thread takes every 'threads'-th row
+        converters.emplace_back([&file, &producer, &running, t, threads]() {
+            try {
+                for (unsigned i = t; i < file.rowCount(); i += threads) {
+                    Bid bid;
+                    bid.bidId = file[i][1];
+                    bid.title = file[i][0];
+                    bid.fund = file[i][8];
+                    bid.amount = strToDouble(file[i][4], '$');
+
+                    producer.Push(move(bid));
+                }
+            } catch (csv::Error &e) {
+                std::cerr << e.what() << std::endl;
+            }
+            running.fetch_sub(1, memory_order_release);
+        });
+    }
+
+    // Drain the queue until every converter is done and nothing is left
+    Bid bid;
+    while (true) {
+        if (queue.Pop(bid)) {
+            list->Append(move(bid));
+        }
+        else if (running.load(memory_order_acquire) == 0) {
+            // Every push has been fully linked in by now
+            while (queue.Pop(bid))
+                list->Append(move(bid));
+            break;
+        }
+        else {
+            this_thread::yield();
+        }
+    }
+
+    for (thread& converter : converters)
+        converter.join();
 }
 
 /**
@@ -340,7 +2564,12 @@ int main(int argc, char* argv[]) {
 
     clock_t ticks;
 
-    LinkedList bidList;
+    // Start with the plain linked list
+    int mode = 0;
+    BidList* bidList = makeList(mode);
+
+    // The cache in front of the list, in the cached mode
+    CachedBidList* cachedList;
 
     Bid bid;
 
@@ -352,6 +2581,10 @@ int main(int argc, char* argv[]) {
         cout << "  3. Display All Bids" << endl;
         cout << "  4. Find Bid" << endl;
         cout << "  5. Remove Bid" << endl;
+        cout << "  6. Switch List Mode" << endl;
+        cout << "  7. Load Bids (parallel)" << endl;
+        cout << "  8. Sort Bids By Title" << endl;
+        cout << "  10. Query Bids" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -359,8 +2592,8 @@ int main(int argc, char* argv[]) {
         switch (choice) {
         case 1:
             bid = getBid();
-            bidList.Append(bid);
-            // bidList.Prepend(bid); // DEBUG
+            bidList->Append(bid);
+            // bidList->Prepend(bid); // DEBUG
             displayBid(bid);
 
             break;
@@ -368,9 +2601,9 @@ int main(int argc, char* argv[]) {
         case 2:
             ticks = clock();
 
-            loadBids(csvPath, &bidList);
+            loadBids(csvPath, bidList);
 
-            cout << bidList.Size() << " bids read" << endl;
+            cout << bidList->Size() << " bids read" << endl;
 
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
             cout << "time: " << ticks << " milliseconds" << endl;
@@ -379,16 +2612,16 @@ int main(int argc, char* argv[]) {
             break;
 
         case 3:
-            bidList.PrintList();
+            bidList->PrintList();
 
-            // cout << "Size: " << bidList.Size() << endl; // DEBUG
+            // cout << "Size: " << bidList->Size() << endl; // DEBUG
 
             break;
 
         case 4:
             ticks = clock();
 
-            bid = bidList.Search(bidKey);
+            bid = bidList->Search(bidKey);
 
             ticks = clock() - ticks; // current clock ticks minus starting clock ticks
 
@@ -398,13 +2631,83 @@ int main(int argc, char* argv[]) {
             	cout << "Bid Id " << bidKey << " not found." << endl;
             }
 
+            cachedList = dynamic_cast<CachedBidList*>(bidList);
+            if (cachedList) {
+                cout << "cache: " << cachedList->Cache().HitRate() * 100 << "% hits, "
+                        << cachedList->Cache().Evictions() << " evictions" << endl;
+            }
+
             cout << "time: " << ticks << " clock ticks" << endl;
             cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
             break;
 
         case 5:
-            bidList.Remove(bidKey);
+            bidList->Remove(bidKey);
+
+            break;
+
+        case 6:
+            // The new list starts empty
+            delete bidList;
+            mode = (mode + 1) % LIST_MODE_COUNT;
+            bidList = makeList(mode);
+
+            cout << "Using " << LIST_MODES[mode] << " (empty)" << endl;
+
+            break;
+
+        case 7:
+            ticks = clock();
+
+            loadBidsParallel(csvPath, bidList, max(2u, thread::hardware_concurrency()));
+
+            cout << bidList->Size() << " bids read" << endl;
+
+            ticks = clock() - ticks; // CPU time of every thread, not wall-clock time
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 8:
+            // Only the linked modes can be sorted in place
+            cachedList = dynamic_cast<CachedBidList*>(bidList);
+            if (LinkedList* linkedList = dynamic_cast<LinkedList*>(cachedList ? cachedList->Inner() : bidList)) {
+                sortByTitle(linkedList);
+
+                // Sorting can change which of two equal IDs a search finds first
+                if (cachedList) {
+                    cachedList->Invalidate();
+                }
+            } else {
+                cout << "Sorting needs a linked list mode" << endl;
+            }
+
+            break;
+
+        case 10:
+            cachedList = dynamic_cast<CachedBidList*>(bidList);
+            if (LinkedList* linkedList = dynamic_cast<LinkedList*>(cachedList ? cachedList->Inner() : bidList)) {
+                BidQuery query = getBidQuery();
+                string plan;
+
+                ticks = clock();
+
+                vector<Bid> matches = linkedList->Query(query, &plan);
+
+                ticks = clock() - ticks;
+
+                for (const Bid& match : matches) {
+                    displayBid(match);
+                }
+                cout << matches.size() << " bids found (" << plan << ")" << endl;
+
+                cout << "time: " << ticks << " clock ticks" << endl;
+                cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+            } else {
+                cout << "Queries need a linked list mode" << endl;
+            }
 
             break;
         }
@@ -412,5 +2715,7 @@ int main(int argc, char* argv[]) {
 
     cout << "Good bye." << endl;
 
+    delete bidList;
+
     return 0;
 }
@@ -1,6 +1,27 @@
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
 #include <time.h>
+#include <type_traits>
+#include <unordered_map>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 // (borrowed)
 #include "CSVparser.hpp"
@@ -14,6 +35,27 @@ using namespace std;
 // forward declarations
 double strToDouble(string str, char ch);
 
+// Ranges this small are finished off with an insertion sort
+const int INSERTION_SORT_CUTOFF = 16;
+
+// Ranges at least this large pick their pivot from nine samples (Tukey's ninther)
+const int NINTHER_THRESHOLD = 128;
+
+// The parallel sort hands ranges larger than this to the thread pool
+const int PARALLEL_SORT_THRESHOLD = 4096;
+
+// The title radix sort finishes buckets this small with an insertion sort
+const int RADIX_SORT_CUTOFF = 32;
+
+// Most runs the external sort merges at once; more take extra merge passes
+const unsigned MAX_MERGE_FAN_IN = 128;
+
+// Bid ids up to this many characters are stored inside a CompactBid
+const unsigned BID_ID_CAPACITY = 11;
+
+// Bytes of CSV text the aggregation hands to each task
+const size_t AGGREGATE_BATCH_BYTES = 1 << 20;
+
 // define a structure to hold bid information
 struct Bid {
     string bidId; // unique identifier
@@ -26,180 +68,2351 @@ struct Bid {
 };
 
 //============================================================================
-// Static methods used for testing
+// Sort keys: comparators the sorts are templated on, so each key's
+// comparison is inlined into its own copy of the algorithm
+//============================================================================
+
+struct ByTitle {
+	bool operator()(const Bid& a, const Bid& b) const {
+		return a.title < b.title;
+	}
+};
+
+struct ByFund {
+	bool operator()(const Bid& a, const Bid& b) const {
+		return a.fund < b.fund;
+	}
+};
+
+struct ByAmount {
+	bool operator()(const Bid& a, const Bid& b) const {
+		return a.amount < b.amount;
+	}
+};
+
+// Numeric order for numeric ids: shorter is smaller, then digit by digit
+struct ById {
+	bool operator()(const Bid& a, const Bid& b) const {
+		if (a.bidId.size() != b.bidId.size())
+			return a.bidId.size() < b.bidId.size();
+		return a.bidId < b.bidId;
+	}
+};
+
+// Reverse of another key
+template <typename Compare>
+struct Descending {
+	Compare less;
+
+	bool operator()(const Bid& a, const Bid& b) const {
+		return less(b, a);
+	}
+};
+
+// Sort by First, breaking ties with Second
+template <typename First, typename Second>
+struct ThenBy {
+	First first;
+	Second second;
+
+	bool operator()(const Bid& a, const Bid& b) const {
+		if (first(a, b))
+			return true;
+		if (first(b, a))
+			return false;
+		return second(a, b);
+	}
+};
+
+//============================================================================
+// Compact bid storage: interned funds, inline ids, titles in a shared arena
 //============================================================================
 
 /**
- * Display the bid information to the console (std::out)
- *
- * @param bid struct containing the bid info
+ * Interns strings with few distinct values (such as fund),
+ * handing out a 32-bit id for each distinct one
  */
-void displayBid(Bid bid) {
-    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
-            << bid.fund << endl;
-    return;
+class StringPool {
+
+private:
+
+	unordered_map<string, uint32_t> ids;
+	vector<string> values;
+
+public:
+	uint32_t Intern(const string& value);
+	const string& Get(uint32_t id) const;
+	size_t Size() const;
+	size_t MemoryUsage() const;
+};
+
+/**
+ * Where a string lives in a TextArena
+ */
+struct TextRef {
+	uint32_t offset;
+	uint32_t length;
+};
+
+/**
+ * Strings stored back to back in one buffer and addressed by TextRef,
+ * so many short strings cost no per-string allocation or header
+ */
+class TextArena {
+
+private:
+
+	string bytes;
+
+public:
+	TextRef Store(const string& text);
+	string_view View(TextRef ref) const;
+	void Clear();
+	void ShrinkToFit();
+	size_t MemoryUsage() const;
+};
+
+/**
+ * A bid in 32 trivially copyable bytes, read through the BidStore that made it.
+ * Short ids sit inline; a longer id moves to the arena and bidIdLength
+ * is set to SPILLED_ID, with its TextRef in the bidId bytes.
+ */
+struct CompactBid {
+	char bidId[BID_ID_CAPACITY];
+	uint8_t bidIdLength;
+	uint32_t fund;
+	TextRef title;
+	double amount;
+
+	static const uint8_t SPILLED_ID = 0xFF;
+};
+
+static_assert(is_trivially_copyable<CompactBid>::value, "CompactBid must stay trivially copyable");
+static_assert(sizeof(TextRef) <= BID_ID_CAPACITY, "a spilled id's TextRef must fit in bidId");
+
+/**
+ * Owns compact bids along with the fund pool and text arena they point into
+ */
+class BidStore {
+
+private:
+
+	StringPool funds;
+
+	// Titles (and any ids too long to store inline)
+	TextArena arena;
+
+	vector<CompactBid> bids;
+
+public:
+	void Add(const Bid& bid);
+	void Clear();
+	size_t Size() const;
+	const CompactBid& Get(size_t i) const;
+	string_view BidId(const CompactBid& bid) const;
+	string_view Title(const CompactBid& bid) const;
+	const string& Fund(const CompactBid& bid) const;
+	Bid Expand(const CompactBid& bid) const;
+	void SortByTitle();
+	void ShrinkToFit();
+	size_t MemoryUsage() const;
+};
+
+/**
+ * The id for value, adding it if it's new
+ */
+uint32_t StringPool::Intern(const string& value) {
+	auto found = ids.find(value);
+	if (found != ids.end()) {
+		return found->second;
+	}
+
+	uint32_t id = values.size();
+	ids.emplace(value, id);
+	values.push_back(value);
+	return id;
 }
 
 /**
- * Prompt user for bid information using console (std::in)
- *
- * @return Bid struct containing the bid info
+ * The string interned as id
  */
-Bid getBid() {
-    Bid bid;
+const string& StringPool::Get(uint32_t id) const {
+	return values[id];
+}
 
-    cout << "Enter Id: ";
-    cin.ignore();
-    getline(cin, bid.bidId);
+/**
+ * Number of distinct strings
+ */
+size_t StringPool::Size() const {
+	return values.size();
+}
 
-    cout << "Enter title: ";
-    getline(cin, bid.title);
+/**
+ * Rough bytes held: the strings twice (list and map) plus per-entry overhead
+ */
+size_t StringPool::MemoryUsage() const {
+	size_t bytes = values.capacity() * sizeof(string);
+	for (const string& value : values) {
+		bytes += 2 * (value.capacity() + 1) + sizeof(string) + sizeof(uint32_t) + 2 * sizeof(void*);
+	}
+	return bytes;
+}
 
-    cout << "Enter fund: ";
-    cin >> bid.fund;
+/**
+ * Append text to the arena
+ */
+TextRef TextArena::Store(const string& text) {
+	TextRef ref;
+	ref.offset = bytes.size();
+	ref.length = text.size();
+	bytes += text;
+	return ref;
+}
 
-    cout << "Enter amount: ";
-    cin.ignore();
-    string strAmount;
-    getline(cin, strAmount);
-    bid.amount = strToDouble(strAmount, '$');
+/**
+ * View stored text (valid until the arena changes)
+ */
+string_view TextArena::View(TextRef ref) const {
+	return string_view(bytes.data() + ref.offset, ref.length);
+}
 
-    return bid;
+/**
+ * Drop all the text
+ */
+void TextArena::Clear() {
+	bytes.clear();
 }
 
 /**
- * Load a CSV file containing bids into a container
+ * Give back the spare capacity left by growing
+ */
+void TextArena::ShrinkToFit() {
+	bytes.shrink_to_fit();
+}
+
+/**
+ * Bytes held by the buffer
+ */
+size_t TextArena::MemoryUsage() const {
+	return bytes.capacity();
+}
+
+/**
+ * Add a compact copy of a bid
+ */
+void BidStore::Add(const Bid& bid) {
+	CompactBid compact = {};
+
+	if (bid.bidId.size() <= BID_ID_CAPACITY) {
+		bid.bidId.copy(compact.bidId, bid.bidId.size());
+		compact.bidIdLength = bid.bidId.size();
+	}
+	else {
+		TextRef ref = arena.Store(bid.bidId);
+		memcpy(compact.bidId, &ref, sizeof(ref));
+		compact.bidIdLength = CompactBid::SPILLED_ID;
+	}
+
+	compact.fund = funds.Intern(bid.fund);
+	compact.title = arena.Store(bid.title);
+	compact.amount = bid.amount;
+
+	bids.push_back(compact);
+}
+
+/**
+ * Drop every bid and the text they used
+ */
+void BidStore::Clear() {
+	bids.clear();
+	arena.Clear();
+	funds = StringPool();
+}
+
+/**
+ * Number of bids
+ */
+size_t BidStore::Size() const {
+	return bids.size();
+}
+
+/**
+ * The bid at position i
+ */
+const CompactBid& BidStore::Get(size_t i) const {
+	return bids[i];
+}
+
+/**
+ * A bid's id, from its inline bytes or the arena
+ */
+string_view BidStore::BidId(const CompactBid& bid) const {
+	if (bid.bidIdLength == CompactBid::SPILLED_ID) {
+		TextRef ref;
+		memcpy(&ref, bid.bidId, sizeof(ref));
+		return arena.View(ref);
+	}
+	return string_view(bid.bidId, bid.bidIdLength);
+}
+
+/**
+ * A bid's title
+ */
+string_view BidStore::Title(const CompactBid& bid) const {
+	return arena.View(bid.title);
+}
+
+/**
+ * A bid's fund
+ */
+const string& BidStore::Fund(const CompactBid& bid) const {
+	return funds.Get(bid.fund);
+}
+
+/**
+ * Rebuild the full Bid, e.g. for display
+ */
+Bid BidStore::Expand(const CompactBid& bid) const {
+	Bid full;
+	full.bidId = string(BidId(bid));
+	full.title = string(Title(bid));
+	full.fund = Fund(bid);
+	full.amount = bid.amount;
+	return full;
+}
+
+/**
+ * Sort by title; only the 32-byte records move, the text stays put
+ */
+void BidStore::SortByTitle() {
+	sort(bids.begin(), bids.end(), [this](const CompactBid& a, const CompactBid& b) {
+		return Title(a) < Title(b);
+	});
+}
+
+/**
+ * Give back the spare capacity left by growing while loading
+ */
+void BidStore::ShrinkToFit() {
+	bids.shrink_to_fit();
+	arena.ShrinkToFit();
+}
+
+/**
+ * Bytes held by the records, the arena and the fund pool
+ */
+size_t BidStore::MemoryUsage() const {
+	return bids.capacity() * sizeof(CompactBid) + arena.MemoryUsage() + funds.MemoryUsage();
+}
+
+//============================================================================
+// Columnar bid table: one contiguous array per field
+//============================================================================
+
+/**
+ * Bids stored column by column (structure of arrays), so a scan over
+ * amounts reads only amounts. Rows are addressed by number; other
+ * containers can hold row numbers instead of copies of the bids.
+ * The amount kernels keep four independent partial results so the
+ * compiler can keep them in vector registers.
+ */
+class BidTable {
+
+private:
+
+	// Ids and titles
+	TextArena text;
+	StringPool funds;
+
+	vector<TextRef> ids;
+	vector<TextRef> titles;
+	vector<uint32_t> fundIds;
+	vector<double> amounts;
+
+public:
+	uint32_t AddRow(const Bid& bid);
+	void Clear();
+	size_t RowCount() const;
+	Bid Row(uint32_t row) const;
+	string_view BidId(uint32_t row) const;
+	string_view Title(uint32_t row) const;
+	const string& Fund(uint32_t row) const;
+	uint32_t FundId(uint32_t row) const;
+	double Amount(uint32_t row) const;
+	size_t FundCount() const;
+	const string& FundName(uint32_t fundId) const;
+
+	double SumAmount() const;
+	double MinAmount() const;
+	double MaxAmount() const;
+	vector<uint32_t> RowsWithAmountAbove(double threshold) const;
+	double SumAmount(const vector<uint32_t>& rows) const;
+	vector<double> SumAmountByFund() const;
+	vector<uint32_t> RowsByTitle() const;
+};
+
+/**
+ * Append a bid
  *
- * @param csvPath the path to the CSV file to load
- * @return a container holding all the bids read
+ * @return its row number
  */
-vector<Bid> loadBids(string csvPath) {
-    cout << "Loading CSV file " << csvPath << endl;
+uint32_t BidTable::AddRow(const Bid& bid) {
+	ids.push_back(text.Store(bid.bidId));
+	titles.push_back(text.Store(bid.title));
+	fundIds.push_back(funds.Intern(bid.fund));
+	amounts.push_back(bid.amount);
+	return amounts.size() - 1;
+}
 
-    // Define a vector data structure to hold a collection of bids.
-    vector<Bid> bids;
+/**
+ * Remove every row
+ */
+void BidTable::Clear() {
+	text.Clear();
+	funds = StringPool();
+	ids.clear();
+	titles.clear();
+	fundIds.clear();
+	amounts.clear();
+}
 
-    // initialize the CSV Parser using the given path
-    csv::Parser file = csv::Parser(csvPath);
+/**
+ * Number of rows
+ */
+size_t BidTable::RowCount() const {
+	return amounts.size();
+}
 
-    try {
-        // loop to read rows of a CSV file
-        for (unsigned i = 0; i < file.rowCount(); i++) {
+/**
+ * Gather a row back into a Bid
+ */
+Bid BidTable::Row(uint32_t row) const {
+	Bid bid;
+	bid.bidId = string(BidId(row));
+	bid.title = string(Title(row));
+	bid.fund = Fund(row);
+	bid.amount = amounts[row];
+	return bid;
+}
 
-            // Create a data structure and add to the collection of bids
-            Bid bid;
-            bid.bidId = file[i][1];
-            bid.title = file[i][0];
-            bid.fund = file[i][8];
-            bid.amount = strToDouble(file[i][4], '$');
+string_view BidTable::BidId(uint32_t row) const {
+	return text.View(ids[row]);
+}
 
-            //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
+string_view BidTable::Title(uint32_t row) const {
+	return text.View(titles[row]);
+}
+
+const string& BidTable::Fund(uint32_t row) const {
+	return funds.Get(fundIds[row]);
+}
+
+uint32_t BidTable::FundId(uint32_t row) const {
+	return fundIds[row];
+}
+
+double BidTable::Amount(uint32_t row) const {
+	return amounts[row];
+}
+
+/**
+ * Number of distinct funds; fund ids run from 0 to this - 1
+ */
+size_t BidTable::FundCount() const {
+	return funds.Size();
+}
+
+const string& BidTable::FundName(uint32_t fundId) const {
+	return funds.Get(fundId);
+}
+
+/**
+ * Total of the amount column
+ */
+double BidTable::SumAmount() const {
+	const double* amount = amounts.data();
+	size_t size = amounts.size();
+	double sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+
+	size_t i = 0;
+	for (; i + 4 <= size; i += 4) {
+		sum0 += amount[i];
+		sum1 += amount[i + 1];
+		sum2 += amount[i + 2];
+		sum3 += amount[i + 3];
+	}
+	for (; i < size; ++i)
+		sum0 += amount[i];
+
+	return (sum0 + sum1) + (sum2 + sum3);
+}
+
+/**
+ * Smallest amount (0 for an empty table)
+ */
+double BidTable::MinAmount() const {
+	if (amounts.empty()) {
+		return 0;
+	}
+
+	const double* amount = amounts.data();
+	size_t size = amounts.size();
+	double min0 = amount[0], min1 = amount[0], min2 = amount[0], min3 = amount[0];
+
+	size_t i = 0;
+	for (; i + 4 <= size; i += 4) {
+		min0 = amount[i] < min0 ? amount[i] : min0;
+		min1 = amount[i + 1] < min1 ? amount[i + 1] : min1;
+		min2 = amount[i + 2] < min2 ? amount[i + 2] : min2;
+		min3 = amount[i + 3] < min3 ? amount[i + 3] : min3;
+	}
+	for (; i < size; ++i)
+		min0 = amount[i] < min0 ? amount[i] : min0;
+
+	return min(min(min0, min1), min(min2, min3));
+}
+
+/**
+ * Largest amount (0 for an empty table)
+ */
+double BidTable::MaxAmount() const {
+	if (amounts.empty()) {
+		return 0;
+	}
+
+	const double* amount = amounts.data();
+	size_t size = amounts.size();
+	double max0 = amount[0], max1 = amount[0], max2 = amount[0], max3 = amount[0];
+
+	size_t i = 0;
+	for (; i + 4 <= size; i += 4) {
+		max0 = amount[i] > max0 ? amount[i] : max0;
+		max1 = amount[i + 1] > max1 ? amount[i + 1] : max1;
+		max2 = amount[i + 2] > max2 ? amount[i + 2] : max2;
+		max3 = amount[i + 3] > max3 ? amount[i + 3] : max3;
+	}
+	for (; i < size; ++i)
+		max0 = amount[i] > max0 ? amount[i] : max0;
+
+	return max(max(max0, max1), max(max2, max3));
+}
+
+/**
+ * Row numbers of the bids with amount > threshold, in row order
+ * Branch-free: every row is written, and the output only advances
+ * past the ones that pass, so unpredictable data costs no mispredicts.
+ */
+vector<uint32_t> BidTable::RowsWithAmountAbove(double threshold) const {
+	vector<uint32_t> rows(amounts.size() + 1);
+	const double* amount = amounts.data();
+	size_t count = 0;
+
+	for (size_t i = 0; i < amounts.size(); ++i) {
+		rows[count] = i;
+		count += amount[i] > threshold;
+	}
+
+	rows.resize(count);
+	return rows;
+}
+
+/**
+ * Total amount of the given rows
+ */
+double BidTable::SumAmount(const vector<uint32_t>& rows) const {
+	double sum = 0;
+	for (uint32_t row : rows)
+		sum += amounts[row];
+	return sum;
+}
+
+/**
+ * Total amount per fund, indexed by fund id
+ */
+vector<double> BidTable::SumAmountByFund() const {
+	vector<double> totals(funds.Size(), 0.0);
+	for (size_t i = 0; i < amounts.size(); ++i)
+		totals[fundIds[i]] += amounts[i];
+	return totals;
+}
+
+/**
+ * Row numbers in title order, an index over the table
+ */
+vector<uint32_t> BidTable::RowsByTitle() const {
+	vector<uint32_t> rows(amounts.size());
+	for (uint32_t i = 0; i < rows.size(); ++i)
+		rows[i] = i;
+
+	stable_sort(rows.begin(), rows.end(), [this](uint32_t a, uint32_t b) {
+		return Title(a) < Title(b);
+	});
+	return rows;
+}
+
+//============================================================================
+// Aggregation: count/sum/avg/min/max of amount, grouped by a column
+//============================================================================
+
+/**
+ * Running statistics over a set of amounts
+ */
+struct AmountStats {
+	size_t count = 0;
+	double sum = 0;
+	double min = 0;
+	double max = 0;
+
+	double Average() const {
+		return count == 0 ? 0 : sum / count;
+	}
+
+	void Merge(const AmountStats& other) {
+		if (other.count == 0)
+			return;
+
+		min = (count == 0 || other.min < min) ? other.min : min;
+		max = (count == 0 || other.max > max) ? other.max : max;
+		count += other.count;
+		sum += other.sum;
+	}
+};
+
+/**
+ * Summarize a contiguous array of amounts
+ * Four lanes at a time with AVX2 when the build targets it
+ * (e.g. -mavx2 or -march=native), otherwise four scalar lanes.
+ */
+AmountStats summarizeAmounts(const double* values, size_t size) {
+	AmountStats stats;
+	if (size == 0) {
+		return stats;
+	}
+
+	size_t i = 0;
+	double sum = 0;
+	double low = values[0];
+	double high = values[0];
+
+#if defined(__AVX2__)
+	__m256d sums = _mm256_setzero_pd();
+	__m256d lows = _mm256_set1_pd(values[0]);
+	__m256d highs = lows;
+
+	for (; i + 4 <= size; i += 4) {
+		__m256d v = _mm256_loadu_pd(values + i);
+		sums = _mm256_add_pd(sums, v);
+		lows = _mm256_min_pd(lows, v);
+		highs = _mm256_max_pd(highs, v);
+	}
+
+	double lanes[4];
+	_mm256_storeu_pd(lanes, sums);
+	sum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+	_mm256_storeu_pd(lanes, lows);
+	low = min(min(lanes[0], lanes[1]), min(lanes[2], lanes[3]));
+	_mm256_storeu_pd(lanes, highs);
+	high = max(max(lanes[0], lanes[1]), max(lanes[2], lanes[3]));
+#else
+	double sum1 = 0, sum2 = 0, sum3 = 0;
+	for (; i + 4 <= size; i += 4) {
+		sum += values[i];
+		sum1 += values[i + 1];
+		sum2 += values[i + 2];
+		sum3 += values[i + 3];
+		low = min(min(low, values[i]), min(values[i + 1], min(values[i + 2], values[i + 3])));
+		high = max(max(high, values[i]), max(values[i + 1], max(values[i + 2], values[i + 3])));
+	}
+	sum = (sum + sum1) + (sum2 + sum3);
+#endif
+
+	for (; i < size; ++i) {
+		sum += values[i];
+		low = min(low, values[i]);
+		high = max(high, values[i]);
+	}
+
+	stats.count = size;
+	stats.sum = sum;
+	stats.min = low;
+	stats.max = high;
+	return stats;
+}
+
+/**
+ * Hash aggregate: one AmountStats per distinct group key
+ */
+class GroupAggregate {
+
+private:
+
+	StringPool groups;
+	vector<AmountStats> stats;
+
+public:
+	uint32_t Group(const string& key);
+	void Add(uint32_t group, const AmountStats& amounts);
+	void Merge(const GroupAggregate& other);
+	size_t Size() const;
+	const string& Key(uint32_t group) const;
+	const AmountStats& Stats(uint32_t group) const;
+};
+
+/**
+ * The id of a group, adding it if it's new
+ */
+uint32_t GroupAggregate::Group(const string& key) {
+	uint32_t group = groups.Intern(key);
+	if (group >= stats.size()) {
+		stats.resize(group + 1);
+	}
+	return group;
+}
+
+/**
+ * Fold summarized amounts into a group
+ */
+void GroupAggregate::Add(uint32_t group, const AmountStats& amounts) {
+	stats[group].Merge(amounts);
+}
+
+/**
+ * Fold in another aggregate (e.g. one thread's partial result)
+ */
+void GroupAggregate::Merge(const GroupAggregate& other) {
+	for (uint32_t group = 0; group < other.Size(); ++group) {
+		Add(Group(other.Key(group)), other.Stats(group));
+	}
+}
+
+/**
+ * Number of groups
+ */
+size_t GroupAggregate::Size() const {
+	return stats.size();
+}
+
+const string& GroupAggregate::Key(uint32_t group) const {
+	return groups.Get(group);
+}
+
+const AmountStats& GroupAggregate::Stats(uint32_t group) const {
+	return stats[group];
+}
+
+//============================================================================
+// Work-stealing thread pool definition
+//============================================================================
+
+/**
+ * A fixed-size pool of worker threads, each with its own task deque.
+ * A worker pushes and pops at the back of its own deque and, when that
+ * runs dry, steals from the front of the others. The thread that creates
+ * the pool counts as worker 0 and runs tasks while it waits, so a pool
+ * of n threads starts n - 1 extra threads.
+ */
+class WorkStealingPool {
+
+private:
+
+	struct WorkQueue {
+		mutex lock;
+		deque<function<void()>> tasks;
+	};
+
+	vector<unique_ptr<WorkQueue>> queues;
+	vector<thread> workers;
+
+	// Tasks sitting in any of the queues, so idle workers know when to wake
+	atomic<int> queued;
+	atomic<bool> done;
+	mutex idleLock;
+	condition_variable idle;
+
+	// Index of the worker running on this thread (0 for the creating thread)
+	static thread_local unsigned currentWorker;
+
+	bool PopLocal(unsigned self, function<void()>& task);
+	bool Steal(unsigned self, function<void()>& task);
+	void WorkerLoop(unsigned self);
+
+public:
+	WorkStealingPool(unsigned threads);
+	virtual ~WorkStealingPool();
+	unsigned Size() const;
+	void Submit(function<void()> task);
+	bool RunPending();
+	void Wait(atomic<int>& pending);
+};
+
+thread_local unsigned WorkStealingPool::currentWorker = 0;
+
+/**
+ * Start threads - 1 workers; the calling thread is the remaining one
+ */
+WorkStealingPool::WorkStealingPool(unsigned threads) : queued(0), done(false) {
+	if (threads == 0) {
+		threads = 1;
+	}
+
+	for (unsigned i = 0; i < threads; ++i) {
+		queues.push_back(unique_ptr<WorkQueue>(new WorkQueue()));
+	}
+
+	for (unsigned i = 1; i < threads; ++i) {
+		workers.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+	}
+}
+
+/**
+ * Destructor: wake and join the workers
+ */
+WorkStealingPool::~WorkStealingPool() {
+	{
+		lock_guard<mutex> guard(idleLock);
+		done = true;
+	}
+	idle.notify_all();
+
+	for (thread& worker : workers) {
+		worker.join();
+	}
+}
+
+/**
+ * Number of threads working for the pool, including the creating thread
+ */
+unsigned WorkStealingPool::Size() const {
+	return queues.size();
+}
+
+/**
+ * Queue a task on the current worker's own deque
+ *
+ * @param task the work to run
+ */
+void WorkStealingPool::Submit(function<void()> task) {
+	{
+		lock_guard<mutex> guard(queues[currentWorker]->lock);
+		queues[currentWorker]->tasks.push_back(move(task));
+	}
+
+	{
+		lock_guard<mutex> guard(idleLock);
+		++queued;
+	}
+	idle.notify_one();
+}
+
+/**
+ * Take the newest task from a worker's own deque
+ */
+bool WorkStealingPool::PopLocal(unsigned self, function<void()>& task) {
+	lock_guard<mutex> guard(queues[self]->lock);
+	if (queues[self]->tasks.empty()) {
+		return false;
+	}
+
+	task = move(queues[self]->tasks.back());
+	queues[self]->tasks.pop_back();
+	--queued;
+	return true;
+}
+
+/**
+ * Take the oldest task from some other worker's deque
+ * The oldest tasks are the biggest ranges, so one steal buys a lot of work
+ */
+bool WorkStealingPool::Steal(unsigned self, function<void()>& task) {
+	for (unsigned i = 1; i < queues.size(); ++i) {
+		WorkQueue& victim = *queues[(self + i) % queues.size()];
+
+		lock_guard<mutex> guard(victim.lock);
+		if (!victim.tasks.empty()) {
+			task = move(victim.tasks.front());
+			victim.tasks.pop_front();
+			--queued;
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * Run one queued task on the calling thread, if there is one
+ *
+ * @return true if a task was run
+ */
+bool WorkStealingPool::RunPending() {
+	function<void()> task;
+	if (PopLocal(currentWorker, task) || Steal(currentWorker, task)) {
+		task();
+		return true;
+	}
+	return false;
+}
+
+/**
+ * Help run tasks until the pending count drops to zero
+ *
+ * @param pending counter the submitted tasks decrement when they finish
+ */
+void WorkStealingPool::Wait(atomic<int>& pending) {
+	while (pending.load() > 0) {
+		if (!RunPending()) {
+			this_thread::yield();
+		}
+	}
+}
+
+/**
+ * Body of each worker thread: run tasks, sleep when there are none
+ */
+void WorkStealingPool::WorkerLoop(unsigned self) {
+	currentWorker = self;
+
+	while (true) {
+		if (RunPending()) {
+			continue;
+		}
+
+		unique_lock<mutex> guard(idleLock);
+		idle.wait(guard, [this] { return done || queued.load() > 0; });
+		if (done) {
+			return;
+		}
+	}
+}
+
+//============================================================================
+// External sort runs: bids spilled to binary files, merged with a loser tree
+//============================================================================
+
+/**
+ * Write a length-prefixed string
+ */
+void writeString(ostream& out, const string& str) {
+	uint32_t length = str.size();
+	out.write((const char*) &length, sizeof(length));
+	out.write(str.data(), length);
+}
+
+/**
+ * Read a length-prefixed string
+ *
+ * @return false at the end of the stream
+ */
+bool readString(istream& in, string& str) {
+	uint32_t length = 0;
+	if (!in.read((char*) &length, sizeof(length))) {
+		return false;
+	}
+	str.resize(length);
+	return (bool) in.read(&str[0], length);
+}
+
+/**
+ * Write a bid as a binary record
+ */
+void writeBid(ostream& out, const Bid& bid) {
+	writeString(out, bid.bidId);
+	writeString(out, bid.title);
+	writeString(out, bid.fund);
+	out.write((const char*) &bid.amount, sizeof(bid.amount));
+}
+
+/**
+ * Read a bid written by writeBid
+ *
+ * @return false at the end of the stream
+ */
+bool readBid(istream& in, Bid& bid) {
+	return readString(in, bid.bidId) && readString(in, bid.title) && readString(in, bid.fund)
+			&& in.read((char*) &bid.amount, sizeof(bid.amount));
+}
+
+/**
+ * k-way merge of sorted run files.
+ * Each internal node of the tree holds the run that lost the match played
+ * there; tree[0] holds the overall winner. Taking the winner and reading
+ * that run's next bid replays only the matches on its path to the root,
+ * so each output bid costs log2(k) comparisons.
+ * Ties go to the earlier run, so merging runs in file order is stable.
+ */
+template <typename Compare>
+class LoserTree {
+
+private:
+
+	Compare less;
+	vector<unique_ptr<ifstream>> runs;
+
+	// Current bid of each run, and whether the run still has one
+	vector<Bid> heads;
+	vector<bool> live;
+
+	// tree[0] = winner, tree[1..k-1] = losers of the internal matches
+	vector<int> tree;
+
+	/**
+	 * Whether run a's head should come out before run b's
+	 */
+	bool Beats(int a, int b) {
+		if (!live[a] || !live[b])
+			return live[a];
+		if (less(heads[a], heads[b]))
+			return true;
+		if (less(heads[b], heads[a]))
+			return false;
+		return a < b;
+	}
+
+	/**
+	 * Play run's head up the tree to the root
+	 */
+	void Replay(int run) {
+		int winner = run;
+		for (int node = (run + (int) runs.size()) / 2; node > 0; node /= 2) {
+			// While building, the first run to reach a node waits there
+			if (tree[node] < 0) {
+				tree[node] = winner;
+				return;
+			}
+			if (Beats(tree[node], winner))
+				swap(tree[node], winner);
+		}
+		tree[0] = winner;
+	}
+
+public:
+
+	LoserTree(const vector<string>& runPaths, Compare less) : less(less) {
+		heads.resize(runPaths.size());
+		live.resize(runPaths.size());
+		tree.assign(max((int) runPaths.size(), 1), -1);
+
+		for (unsigned i = 0; i < runPaths.size(); ++i) {
+			runs.push_back(unique_ptr<ifstream>(new ifstream(runPaths[i], ios::binary)));
+			live[i] = readBid(*runs[i], heads[i]);
+		}
+
+		for (int i = (int) runPaths.size() - 1; i >= 0; --i)
+			Replay(i);
+	}
+
+	/**
+	 * Whether every run has been used up
+	 */
+	bool Empty() const {
+		return runs.empty() || !live[tree[0]];
+	}
+
+	/**
+	 * The smallest bid left in any run
+	 */
+	const Bid& Top() const {
+		return heads[tree[0]];
+	}
+
+	/**
+	 * Drop the smallest bid and bring in the next one from its run
+	 */
+	void Pop() {
+		int run = tree[0];
+		live[run] = readBid(*runs[run], heads[run]);
+		Replay(run);
+	}
+};
+
+//============================================================================
+// Static methods used for testing
+//============================================================================
+
+/**
+ * Display the bid information to the console (std::out)
+ *
+ * @param bid struct containing the bid info
+ */
+void displayBid(Bid bid) {
+    cout << bid.bidId << ": " << bid.title << " | " << bid.amount << " | "
+            << bid.fund << endl;
+    return;
+}
+
+/**
+ * Prompt user for bid information using console (std::in)
+ *
+ * @return Bid struct containing the bid info
+ */
+Bid getBid() {
+    Bid bid;
+
+    cout << "Enter Id: ";
+    cin.ignore();
+    getline(cin, bid.bidId);
+
+    cout << "Enter title: ";
+    getline(cin, bid.title);
+
+    cout << "Enter fund: ";
+    cin >> bid.fund;
+
+    cout << "Enter amount: ";
+    cin.ignore();
+    string strAmount;
+    getline(cin, strAmount);
+    bid.amount = strToDouble(strAmount, '$');
+
+    return bid;
+}
+
+/**
+ * Build a bid from a row of the eBid CSV export
+ *
+ * @param row A parsed row
+ * @return the bid it holds
+ */
+Bid bidFromRow(const csv::Row& row) {
+    Bid bid;
+    bid.bidId = row[1];
+    bid.title = row[0];
+    bid.fund = row[8];
+    bid.amount = strToDouble(row[4], '$');
+    return bid;
+}
+
+/**
+ * Load a CSV file containing bids into a container
+ *
+ * @param csvPath the path to the CSV file to load
+ * @return a container holding all the bids read
+ */
+vector<Bid> loadBids(string csvPath) {
+    cout << "Loading CSV file " << csvPath << endl;
+
+    // Define a vector data structure to hold a collection of bids.
+    vector<Bid> bids;
+
+    // initialize the CSV Parser using the given path
+    csv::Parser file = csv::Parser(csvPath);
+
+    // No growth slack, so the memory report counts only the bids
+    bids.reserve(file.rowCount());
+
+    try {
+        // loop to read rows of a CSV file
+        for (unsigned i = 0; i < file.rowCount(); i++) {
+
+            // Create a data structure and add to the collection of bids
+            Bid bid = bidFromRow(file[i]);
+
+            //cout << "Item: " << bid.title << ", Fund: " << bid.fund << ", Amount: " << bid.amount << endl;
+
+            // push this bid to the end
+            bids.push_back(bid);
+        }
+    } catch (csv::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+    return bids;
+}
+
+/**
+ * Index of the median of three bids
+ */
+template <typename Compare>
+int medianOfThree(vector<Bid>& bids, int a, int b, int c, Compare less) {
+	const Bid& x = bids[a];
+	const Bid& y = bids[b];
+	const Bid& z = bids[c];
+
+	if (less(x, y))
+		return less(y, z) ? b : (less(x, z) ? c : a);
+	return less(x, z) ? a : (less(y, z) ? c : b);
+}
+
+/**
+ * Move a good pivot to the start of the range:
+ * the median of the first, middle and last bids,
+ * or for large ranges the median of three such medians (ninther)
+ */
+template <typename Compare>
+void choosePivot(vector<Bid>& bids, int begin, int end, Compare less) {
+	int mid = begin + (end - begin) / 2;
+	int pivot;
+
+	if (end - begin + 1 >= NINTHER_THRESHOLD) {
+		int step = (end - begin + 1) / 8;
+		pivot = medianOfThree(bids,
+				medianOfThree(bids, begin, begin + step, begin + 2 * step, less),
+				medianOfThree(bids, mid - step, mid, mid + step, less),
+				medianOfThree(bids, end - 2 * step, end - step, end, less), less);
+	}
+	else {
+		pivot = medianOfThree(bids, begin, mid, end, less);
+	}
+
+	swap(bids[pivot], bids[begin]);
+}
+
+/**
+ * Partition the vector of bids into two parts, low and high,
+ * around a pivot that ends up in its final sorted position
+ *
+ * @param bids Address of the vector<Bid> instance to be partitioned
+ * @param begin Beginning index to partition
+ * @param end Ending index to partition
+ * @param less the sort key (title by default)
+ * @return the pivot's index: bids before it are not greater, bids after it not less
+ */
+template <typename Compare = ByTitle>
+int partition(vector<Bid>& bids, int begin, int end, Compare less = Compare()) {
+	// Park the pivot at begin, out of the way of the swaps, so it can be
+	// compared in place rather than copied out
+	choosePivot(bids, begin, end, less);
+	const Bid& pivot = bids[begin];
+
+	// Low and high
+	int low  = begin + 1;
+	int high = end;
+
+	while (true) {
+
+		// Increment the low...
+		while (low <= high && less(bids[low], pivot)) {
+			++low;
+		}
+
+		// And decrement the high...
+		while (low <= high && less(pivot, bids[high])) {
+			--high;
+		}
+
+		// Stop when the two indices 'cross'
+		if (low >= high) {
+			break;
+		}
+
+		// Swap the inverted pair (where the elements < the pivot & > the pivot are in the wrong order)
+		// std::swap moves the strings rather than copying them.
+		// Bids equal to the pivot are swapped too, which splits runs of them evenly.
+		swap(bids[low++], bids[high--]);
+	}
+
+	// bids[high] is not greater than the pivot: swap the pivot into its place
+	swap(bids[begin], bids[high]);
+	return high;
+}
+
+/**
+ * Perform an insertion sort over [begin, end]
+ * Quick on the short, nearly sorted ranges the quick sort leaves behind
+ */
+template <typename Compare = ByTitle>
+void insertionSort(vector<Bid>& bids, int begin, int end, Compare less = Compare()) {
+	for (int i = begin + 1; i <= end; ++i) {
+		// Shift larger bids up until the slot for this one opens
+		Bid bid = move(bids[i]);
+		int j = i - 1;
+
+		while (j >= begin && less(bid, bids[j])) {
+			bids[j + 1] = move(bids[j]);
+			--j;
+		}
+
+		bids[j + 1] = move(bid);
+	}
+}
+
+/**
+ * Restore the max-heap property below a node of the heap in bids[begin, begin + size)
+ */
+template <typename Compare>
+void siftDown(vector<Bid>& bids, int begin, int node, int size, Compare less) {
+	while (true) {
+		int largest = node;
+		int left = 2 * node + 1;
+		int right = left + 1;
+
+		if (left < size && less(bids[begin + largest], bids[begin + left]))
+			largest = left;
+		if (right < size && less(bids[begin + largest], bids[begin + right]))
+			largest = right;
+
+		if (largest == node)
+			return;
+
+		swap(bids[begin + node], bids[begin + largest]);
+		node = largest;
+	}
+}
+
+/**
+ * Perform a heap sort over [begin, end]
+ * Worst case performance O(n log(n)), used when the quick sort recurses too deep
+ */
+template <typename Compare = ByTitle>
+void heapSort(vector<Bid>& bids, int begin, int end, Compare less = Compare()) {
+	int size = end - begin + 1;
+
+	// Build the heap
+	for (int i = size / 2 - 1; i >= 0; --i)
+		siftDown(bids, begin, i, size, less);
+
+	// Repeatedly move the largest to the end of the shrinking heap
+	for (int last = size - 1; last > 0; --last) {
+		swap(bids[begin], bids[begin + last]);
+		siftDown(bids, begin, 0, last, less);
+	}
+}
+
+/**
+ * Introsort over [begin, end]: quick sort that switches to a heap sort
+ * once it has gone depthLimit partitions deep, and to an insertion sort
+ * for small ranges. It recurses into the smaller side and loops on the
+ * larger one, so the stack stays O(log n) deep.
+ */
+template <typename Compare = ByTitle>
+void introSort(vector<Bid>& bids, int begin, int end, int depthLimit, Compare less = Compare()) {
+	while (end - begin + 1 > INSERTION_SORT_CUTOFF) {
+		// Too many bad pivots: finish this range in guaranteed O(n log(n))
+		if (depthLimit == 0) {
+			heapSort(bids, begin, end, less);
+			return;
+		}
+		--depthLimit;
+
+		// Partition index
+		int p = partition(bids, begin, end, less);
+
+		// Sort the smaller side, then carry on with the larger one (the pivot is done)
+		if (p - begin < end - p) {
+			introSort(bids, begin, p - 1, depthLimit, less);
+			begin = p + 1;
+		}
+		else {
+			introSort(bids, p + 1, end, depthLimit, less);
+			end = p - 1;
+		}
+	}
+
+	insertionSort(bids, begin, end, less);
+}
+
+/**
+ * Perform a quick sort (as an introsort), on bid title unless another key is given
+ * Average performance: O(n log(n))
+ * Worst case performance O(n log(n))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param begin the beginning index to sort on
+ * @param end the ending index to sort on (inclusive)
+ * @param less the sort key
+ */
+template <typename Compare = ByTitle>
+void quickSort(vector<Bid>& bids, int begin, int end, Compare less = Compare()) {
+	if (begin < end) {
+		// Allow 2 * log2(n) levels of partitioning
+		int depthLimit = 0;
+		for (int n = end - begin + 1; n > 1; n /= 2)
+			depthLimit += 2;
+
+		introSort(bids, begin, end, depthLimit, less);
+	}
+}
+
+/**
+ * Perform a merge sort, on bid title unless another key is given
+ * Stable: bids with equal keys keep their order, so sorting by one key
+ * and then another leaves ties in the first key's order.
+ * Runs of INSERTION_SORT_CUTOFF are insertion sorted, then merged
+ * bottom-up through a buffer, moving bids rather than copying them.
+ * Worst case performance O(n log(n)), O(n) extra space
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param less the sort key
+ */
+template <typename Compare = ByTitle>
+void stableSort(vector<Bid>& bids, Compare less = Compare()) {
+	int size = bids.size();
+
+	// Insertion sort is stable, so it can build the initial runs
+	for (int begin = 0; begin < size; begin += INSERTION_SORT_CUTOFF)
+		insertionSort(bids, begin, min(begin + INSERTION_SORT_CUTOFF, size) - 1, less);
+
+	vector<Bid> buffer(size);
+	for (int width = INSERTION_SORT_CUTOFF; width < size; width *= 2) {
+		for (int begin = 0; begin < size; begin += 2 * width) {
+			int mid = min(begin + width, size);
+			int end = min(begin + 2 * width, size);
+			int left = begin, right = mid, out = begin;
+
+			// Take from the right only when strictly smaller, to keep ties in order
+			while (left < mid && right < end)
+				buffer[out++] = move(less(bids[right], bids[left]) ? bids[right++] : bids[left++]);
+			while (left < mid)
+				buffer[out++] = move(bids[left++]);
+			while (right < end)
+				buffer[out++] = move(bids[right++]);
+		}
+		bids.swap(buffer);
+	}
+}
+
+/**
+ * Quick sort [begin, end] on the pool: each partition hands its smaller
+ * side to the pool as a task and keeps going with the larger side.
+ * Ranges at or below PARALLEL_SORT_THRESHOLD finish as a plain introsort.
+ */
+void parallelQuickSort(WorkStealingPool& pool, vector<Bid>& bids, int begin, int end,
+		int depthLimit, atomic<int>& pending) {
+	while (end - begin + 1 > PARALLEL_SORT_THRESHOLD) {
+		if (depthLimit == 0) {
+			heapSort(bids, begin, end);
+			return;
+		}
+		--depthLimit;
+
+		// Partition index
+		int p = partition(bids, begin, end);
+
+		// Spawn the smaller side, then carry on with the larger one
+		int taskBegin, taskEnd;
+		if (p - begin < end - p) {
+			taskBegin = begin;
+			taskEnd = p - 1;
+			begin = p + 1;
+		}
+		else {
+			taskBegin = p + 1;
+			taskEnd = end;
+			end = p - 1;
+		}
+
+		++pending;
+		pool.Submit([&pool, &bids, &pending, taskBegin, taskEnd, depthLimit] {
+			parallelQuickSort(pool, bids, taskBegin, taskEnd, depthLimit, pending);
+			--pending;
+		});
+	}
+
+	introSort(bids, begin, end, depthLimit);
+}
+
+/**
+ * Perform a parallel quick sort on bid title
+ * Average performance: O(n log(n)) work spread over the threads
+ * Worst case performance O(n log(n))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param threads number of threads to sort with, including the caller
+ */
+void parallelSort(vector<Bid>& bids, unsigned threads) {
+	if (bids.size() < 2) {
+		return;
+	}
+
+	WorkStealingPool pool(threads);
+	atomic<int> pending(0);
+
+	// Same 2 * log2(n) depth limit as quickSort
+	int depthLimit = 0;
+	for (size_t n = bids.size(); n > 1; n /= 2)
+		depthLimit += 2;
+
+	parallelQuickSort(pool, bids, 0, (int) bids.size() - 1, depthLimit, pending);
+	pool.Wait(pending);
+}
+
+/**
+ * Rearrange the bids so the one at nth is the one a full sort would put
+ * there, with nothing after it ordered before it and nothing before it
+ * ordered after it (quickselect on the partition).
+ * After 2 * log2(n) partitions it heap sorts what is left, so it stays
+ * O(n log(n)) in the worst case; on average it is O(n).
+ *
+ * @param bids address of the vector<Bid> instance to rearrange
+ * @param nth the index to settle
+ * @param less the sort key
+ */
+template <typename Compare = ByTitle>
+void nthElement(vector<Bid>& bids, int nth, Compare less = Compare()) {
+	int begin = 0;
+	int end = (int) bids.size() - 1;
+	if (nth < begin || nth > end) {
+		return;
+	}
+
+	int depthLimit = 0;
+	for (int n = end - begin + 1; n > 1; n /= 2)
+		depthLimit += 2;
+
+	while (end - begin + 1 > INSERTION_SORT_CUTOFF) {
+		if (depthLimit == 0) {
+			heapSort(bids, begin, end, less);
+			return;
+		}
+		--depthLimit;
+
+		// Only the side holding nth needs any more work
+		int p = partition(bids, begin, end, less);
+		if (nth == p)
+			return;
+		if (nth < p)
+			end = p - 1;
+		else
+			begin = p + 1;
+	}
+
+	insertionSort(bids, begin, end, less);
+}
+
+/**
+ * Sort just the first k bids, leaving the rest in no particular order
+ * Average performance: O(n + k log(k))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ * @param k how many bids to put in order
+ * @param less the sort key
+ */
+template <typename Compare = ByTitle>
+void partialSort(vector<Bid>& bids, int k, Compare less = Compare()) {
+	k = min(k, (int) bids.size());
+	if (k <= 0) {
+		return;
+	}
+
+	// Settle the kth bid; everything before it then belongs in the first k
+	nthElement(bids, k - 1, less);
+	quickSort(bids, 0, k - 1, less);
+}
+
+/**
+ * The first k bids in sort order, without rearranging the bids
+ * Keeps a max-heap of the best k indices seen so far, so each bid costs
+ * one comparison against the heap top and at most O(log(k)) to replace it.
+ * Performance: O(n log(k)), O(k) extra space
+ *
+ * @param bids the bids to select from
+ * @param k how many bids to return
+ * @param less the sort key
+ * @return the first k bids, in order
+ */
+template <typename Compare = ByTitle>
+vector<Bid> topK(const vector<Bid>& bids, int k, Compare less = Compare()) {
+	vector<Bid> top;
+	k = min(k, (int) bids.size());
+	if (k <= 0) {
+		return top;
+	}
+
+	// Heap top is the worst of the k kept so far
+	auto byKey = [&bids, &less](unsigned a, unsigned b) { return less(bids[a], bids[b]); };
+	vector<unsigned> heap;
+	heap.reserve(k);
+
+	for (unsigned i = 0; i < bids.size(); ++i) {
+		if ((int) heap.size() < k) {
+			heap.push_back(i);
+			push_heap(heap.begin(), heap.end(), byKey);
+		}
+		else if (less(bids[i], bids[heap.front()])) {
+			pop_heap(heap.begin(), heap.end(), byKey);
+			heap.back() = i;
+			push_heap(heap.begin(), heap.end(), byKey);
+		}
+	}
+
+	sort_heap(heap.begin(), heap.end(), byKey);
+
+	top.reserve(k);
+	for (unsigned index : heap)
+		top.push_back(bids[index]);
+	return top;
+}
+
+/**
+ * Perform a selection sort, on bid title unless another key is given
+ * Average performance: O(n^2))
+ * Worst case performance O(n^2))
+ *
+ * @param bid address of the vector<Bid>
+ *            instance to be sorted
+ * @param less the sort key
+ */
+template <typename Compare = ByTitle>
+void selectionSort(vector<Bid>& bids, Compare less = Compare()) {
+	int size = bids.size();
+
+	// Then successively find the minimum and put it in its correct position
+	for (int i = 0; i < size - 1; ++i) {
+		// Operator [] preferred over bids.at() because the bounds-checking
+		// in the latter is not needed here (we know these indices are valid)
+
+		// set the current element as the min
+		int minIdx = i;
+
+		// Find the minimum in the unsorted part (i + 1 to end)
+		for (int j = i + 1; j < size; ++j)
+			if (less(bids[j], bids[minIdx]))
+				// Reassign the min index if a lower value is found
+				minIdx = j;
+
+		// If the min index changed, swap the ith element with the minimum one
+		if (minIdx != i) {
+			swap(bids[minIdx], bids[i]);
+		}
+	}
+}
+
+/**
+ * Compact sort key for a bid: the first 8 bytes of its title packed
+ * big-endian (so integer order matches string order) and its position
+ */
+struct SortKey {
+	uint64_t prefix;
+	unsigned index;
+};
+
+/**
+ * Pack the first 8 bytes of a title, zero padded, into an integer
+ */
+uint64_t packTitlePrefix(const string& title) {
+	uint64_t prefix = 0;
+	for (unsigned i = 0; i < 8; ++i) {
+		prefix <<= 8;
+		if (i < title.size())
+			prefix |= (unsigned char) title[i];
+	}
+	return prefix;
+}
+
+/**
+ * Work out the title order of the bids without moving them
+ * Most comparisons are settled by the packed prefixes; only keys with
+ * equal prefixes look at the full titles. Ties keep their original
+ * order, so the result is stable.
+ *
+ * @param bids the bids to order
+ * @return the bid indices in ascending title order
+ */
+vector<unsigned> titleOrder(const vector<Bid>& bids) {
+	vector<SortKey> keys(bids.size());
+	for (unsigned i = 0; i < bids.size(); ++i) {
+		keys[i].prefix = packTitlePrefix(bids[i].title);
+		keys[i].index = i;
+	}
+
+	sort(keys.begin(), keys.end(), [&bids](const SortKey& a, const SortKey& b) {
+		if (a.prefix != b.prefix)
+			return a.prefix < b.prefix;
+
+		// Same first 8 bytes: fall back to the rest of the titles
+		int cmp = bids[a.index].title.compare(bids[b.index].title);
+		if (cmp != 0)
+			return cmp < 0;
+		return a.index < b.index;
+	});
+
+	vector<unsigned> order(keys.size());
+	for (unsigned i = 0; i < keys.size(); ++i)
+		order[i] = keys[i].index;
+	return order;
+}
+
+/**
+ * Rearrange the bids into the given order, moving each bid exactly once
+ *
+ * @param bids the bids to rearrange
+ * @param order bid indices, as returned by titleOrder
+ */
+void applyPermutation(vector<Bid>& bids, const vector<unsigned>& order) {
+	vector<Bid> sorted;
+	sorted.reserve(bids.size());
+
+	for (unsigned i = 0; i < order.size(); ++i)
+		sorted.push_back(move(bids[order[i]]));
+
+	bids.swap(sorted);
+}
+
+/**
+ * Perform a key sort on bid title: sort compact keys, then move the bids once
+ * Average performance: O(n log(n))
+ * Worst case performance O(n log(n))
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void keySort(vector<Bid>& bids) {
+	applyPermutation(bids, titleOrder(bids));
+}
+
+/**
+ * Radix digit of a title at the given depth: 0 once the title has ended,
+ * otherwise the byte plus one, so shorter titles sort first
+ */
+inline int titleDigit(const string& title, size_t depth) {
+	return depth < title.size() ? (unsigned char) title[depth] + 1 : 0;
+}
+
+/**
+ * MSD (American flag) radix sort of order[begin, end) by bid title,
+ * where every title in the range shares its first depth bytes.
+ * Each pass counts the digits, permutes the indices into their buckets
+ * in place, then recurses into each bucket on the next byte.
+ */
+void msdRadixSort(const vector<Bid>& bids, vector<unsigned>& order, int begin, int end, size_t depth) {
+	// Small bucket: insertion sort, comparing past the shared prefix only
+	if (end - begin <= RADIX_SORT_CUTOFF) {
+		for (int i = begin + 1; i < end; ++i) {
+			unsigned index = order[i];
+			const string& title = bids[index].title;
+			int j = i - 1;
+
+			while (j >= begin && title.compare(depth, string::npos, bids[order[j]].title, depth, string::npos) < 0) {
+				order[j + 1] = order[j];
+				--j;
+			}
+
+			order[j + 1] = index;
+		}
+		return;
+	}
+
+	// Count the digits
+	int counts[257] = { 0 };
+	for (int i = begin; i < end; ++i) {
+		++counts[titleDigit(bids[order[i]].title, depth)];
+	}
+
+	// Where each bucket starts, and the next free slot in each
+	int starts[258];
+	int next[257];
+	starts[0] = begin;
+	for (int digit = 0; digit < 257; ++digit) {
+		starts[digit + 1] = starts[digit] + counts[digit];
+		next[digit] = starts[digit];
+	}
+
+	// Swap each index into its bucket until every bucket is full
+	for (int digit = 0; digit < 257; ++digit) {
+		while (next[digit] < starts[digit + 1]) {
+			unsigned index = order[next[digit]];
+			int target = titleDigit(bids[index].title, depth);
+
+			while (target != digit) {
+				swap(index, order[next[target]++]);
+				target = titleDigit(bids[index].title, depth);
+			}
+
+			order[next[digit]++] = index;
+		}
+	}
+
+	// Bucket 0 holds titles that ended here, which are all equal
+	for (int digit = 1; digit < 257; ++digit) {
+		if (counts[digit] > 1) {
+			msdRadixSort(bids, order, starts[digit], starts[digit + 1], depth + 1);
+		}
+	}
+}
+
+/**
+ * Perform an MSD radix sort on bid title
+ * Performance: O(total title bytes examined), no full string comparisons
+ * outside small buckets
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void titleRadixSort(vector<Bid>& bids) {
+	vector<unsigned> order(bids.size());
+	for (unsigned i = 0; i < order.size(); ++i)
+		order[i] = i;
+
+	msdRadixSort(bids, order, 0, (int) order.size(), 0);
+	applyPermutation(bids, order);
+}
+
+/**
+ * A 64-bit numeric sort key paired with the position of its bid
+ */
+struct RadixItem {
+	uint64_t key;
+	unsigned index;
+};
+
+/**
+ * LSD radix sort on the keys, a byte per pass, stable
+ * Passes whose byte is the same for every key are skipped, so small
+ * keys such as bid ids only take a few passes.
+ *
+ * @param items the keys to sort
+ * @return the bid indices in ascending key order
+ */
+vector<unsigned> lsdRadixOrder(vector<RadixItem>& items) {
+	// Histogram every byte in one read of the keys
+	vector<size_t> counts(8 * 256, 0);
+	for (const RadixItem& item : items) {
+		for (unsigned pass = 0; pass < 8; ++pass) {
+			++counts[pass * 256 + ((item.key >> (8 * pass)) & 0xFF)];
+		}
+	}
+
+	vector<RadixItem> buffer(items.size());
+	for (unsigned pass = 0; pass < 8; ++pass) {
+		size_t* count = &counts[pass * 256];
+
+		// Every key has the same byte here: nothing to do
+		if (count[(items.empty() ? 0 : (items[0].key >> (8 * pass)) & 0xFF)] == items.size()) {
+			continue;
+		}
+
+		// Prefix sums give each byte value its first output slot
+		size_t offset = 0;
+		for (unsigned digit = 0; digit < 256; ++digit) {
+			size_t c = count[digit];
+			count[digit] = offset;
+			offset += c;
+		}
+
+		for (const RadixItem& item : items) {
+			buffer[count[(item.key >> (8 * pass)) & 0xFF]++] = item;
+		}
+		items.swap(buffer);
+	}
+
+	vector<unsigned> order(items.size());
+	for (unsigned i = 0; i < items.size(); ++i)
+		order[i] = items[i].index;
+	return order;
+}
+
+/**
+ * Perform an LSD radix sort on the numeric bid id
+ * Performance: O(n) per pass, at most 8 passes
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void idRadixSort(vector<Bid>& bids) {
+	vector<RadixItem> items(bids.size());
+	for (unsigned i = 0; i < bids.size(); ++i) {
+		items[i].key = strtoull(bids[i].bidId.c_str(), nullptr, 10);
+		items[i].index = i;
+	}
+
+	applyPermutation(bids, lsdRadixOrder(items));
+}
+
+/**
+ * Perform an LSD radix sort on the bid amount, in whole cents
+ * Performance: O(n) per pass, at most 8 passes
+ *
+ * @param bids address of the vector<Bid> instance to be sorted
+ */
+void amountRadixSort(vector<Bid>& bids) {
+	vector<RadixItem> items(bids.size());
+	for (unsigned i = 0; i < bids.size(); ++i) {
+		// Flipping the sign bit puts negative amounts below positive ones
+		int64_t cents = llround(bids[i].amount * 100);
+		items[i].key = (uint64_t) cents ^ (UINT64_C(1) << 63);
+		items[i].index = i;
+	}
+
+	applyPermutation(bids, lsdRadixOrder(items));
+}
+
+/**
+ * Time one sort on a copy of the bids, in wall time
+ * (clock() adds up CPU time across threads)
+ */
+double timeSort(const vector<Bid>& bids, const function<void(vector<Bid>&)>& sortBids) {
+	vector<Bid> copy = bids;
+	auto start = chrono::steady_clock::now();
+	sortBids(copy);
+	return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Time the title sorts on copies of the bids, including parallelSort
+ * with 1 to maxThreads threads, and print each one's speedup over
+ * quickSort; then time the numeric radix sorts
+ *
+ * @param bids the bids to sort (left unchanged)
+ * @param maxThreads largest thread count to try
+ */
+void benchmarkSorts(const vector<Bid>& bids, unsigned maxThreads) {
+	if (bids.empty()) {
+		cout << "Load bids before benchmarking" << endl;
+		return;
+	}
+
+	double baseline = timeSort(bids, [](vector<Bid>& copy) { quickSort(copy, 0, (int) copy.size() - 1); });
+	cout << "quickSort: " << baseline << " seconds" << endl;
+
+	double elapsed = timeSort(bids, keySort);
+	cout << "keySort: " << elapsed << " seconds, speedup " << baseline / elapsed << "x" << endl;
+
+	elapsed = timeSort(bids, titleRadixSort);
+	cout << "titleRadixSort: " << elapsed << " seconds, speedup " << baseline / elapsed << "x" << endl;
+
+	for (unsigned threads = 1; threads <= maxThreads; ++threads) {
+		elapsed = timeSort(bids, [threads](vector<Bid>& copy) { parallelSort(copy, threads); });
+		cout << "parallelSort, " << threads << " thread(s): " << elapsed << " seconds, speedup "
+				<< baseline / elapsed << "x" << endl;
+	}
+
+	// Numeric keys: radix against a comparison sort on the same key
+	double compared = timeSort(bids, [](vector<Bid>& copy) {
+		stable_sort(copy.begin(), copy.end(), [](const Bid& a, const Bid& b) {
+			return strtoull(a.bidId.c_str(), nullptr, 10) < strtoull(b.bidId.c_str(), nullptr, 10);
+		});
+	});
+	elapsed = timeSort(bids, idRadixSort);
+	cout << "idRadixSort: " << elapsed << " seconds, stable_sort by id: " << compared << " seconds" << endl;
+
+	compared = timeSort(bids, [](vector<Bid>& copy) {
+		stable_sort(copy.begin(), copy.end(), [](const Bid& a, const Bid& b) { return a.amount < b.amount; });
+	});
+	elapsed = timeSort(bids, amountRadixSort);
+	cout << "amountRadixSort: " << elapsed << " seconds, stable_sort by amount: " << compared << " seconds" << endl;
+}
+
+/**
+ * Merge sorted runs into one stream of bids, in MAX_MERGE_FAN_IN-sized
+ * groups: while there are too many runs to open at once, each group is
+ * merged into a new, longer run first
+ *
+ * @param runPaths the run files, in the order they were written; deleted as they are merged
+ * @param tempPrefix path prefix for any intermediate runs
+ * @param emit called with each bid in order
+ * @param less the sort key
+ */
+template <typename Compare>
+void mergeRuns(vector<string> runPaths, const string& tempPrefix,
+		const function<void(const Bid&)>& emit, Compare less) {
+	unsigned pass = 0;
+
+	while (runPaths.size() > MAX_MERGE_FAN_IN) {
+		vector<string> merged;
+
+		for (unsigned first = 0; first < runPaths.size(); first += MAX_MERGE_FAN_IN) {
+			vector<string> group(runPaths.begin() + first,
+					runPaths.begin() + min<size_t>(first + MAX_MERGE_FAN_IN, runPaths.size()));
+
+			string path = tempPrefix + ".merge" + to_string(pass) + "." + to_string(merged.size());
+			ofstream out(path, ios::binary);
+
+			for (LoserTree<Compare> tree(group, less); !tree.Empty(); tree.Pop())
+				writeBid(out, tree.Top());
+
+			for (const string& run : group)
+				remove(run.c_str());
+			merged.push_back(path);
+		}
+
+		runPaths.swap(merged);
+		++pass;
+	}
+
+	for (LoserTree<Compare> tree(runPaths, less); !tree.Empty(); tree.Pop())
+		emit(tree.Top());
+
+	for (const string& run : runPaths)
+		remove(run.c_str());
+}
+
+/**
+ * Sort a bid CSV that may not fit in memory
+ * Reads the file in batches of about memoryBudget / 4 bytes of CSV (the
+ * parser and the parsed bids each hold another copy), sorts each batch
+ * with stableSort and spills it to a binary run next to the output,
+ * then merges the runs with a loser tree straight into the output file.
+ *
+ * The CSV output keeps the input header and puts each bid's fields back
+ * in the columns loadBids reads them from, so it loads like the original.
+ * The binary output is a sequence of writeBid records.
+ *
+ * @param csvPath the CSV file to sort
+ * @param outputPath where to write the sorted bids
+ * @param memoryBudget roughly how many bytes a batch may use
+ * @param binaryOutput write binary records instead of CSV
+ * @param less the sort key
+ * @return the number of bids written
+ */
+template <typename Compare = ByTitle>
+size_t externalSort(const string& csvPath, const string& outputPath, size_t memoryBudget,
+		bool binaryOutput, Compare less = Compare()) {
+	ifstream in(csvPath);
+	if (!in.is_open()) {
+		cout << "Failed to open " << csvPath << endl;
+		return 0;
+	}
+
+	string header;
+	getline(in, header);
+
+	size_t batchBytes = max<size_t>(memoryBudget / 4, 1);
+	vector<string> runPaths;
+	string batch;
+	string line;
+
+	// Parse, sort and spill the lines collected so far
+	auto spill = [&]() {
+		if (batch.empty()) {
+			return;
+		}
+
+		vector<Bid> bids;
+		try {
+			csv::Parser file = csv::Parser(header + "\n" + batch, csv::ePURE);
+			bids.reserve(file.rowCount());
+
+			for (unsigned i = 0; i < file.rowCount(); i++) {
+				bids.push_back(bidFromRow(file[i]));
+			}
+		} catch (csv::Error &e) {
+			std::cerr << e.what() << std::endl;
+		}
+		batch.clear();
+
+		stableSort(bids, less);
+
+		string path = outputPath + ".run" + to_string(runPaths.size());
+		ofstream out(path, ios::binary);
+		for (const Bid& bid : bids)
+			writeBid(out, bid);
+		runPaths.push_back(path);
+	};
+
+	while (getline(in, line)) {
+		if (line.empty()) {
+			continue;
+		}
+
+		batch += line;
+		batch += '\n';
+
+		if (batch.size() >= batchBytes) {
+			spill();
+		}
+	}
+	spill();
+
+	ofstream out(outputPath, binaryOutput ? ios::binary : ios::out);
+	size_t written = 0;
+
+	if (binaryOutput) {
+		mergeRuns(runPaths, outputPath, [&](const Bid& bid) {
+			writeBid(out, bid);
+			++written;
+		}, less);
+	}
+	else {
+		out << header << '\n';
+		out << fixed << setprecision(2);
+
+		// The parser wants every row as wide as the header; columns loadBids doesn't read stay empty
+		unsigned columns = count(header.begin(), header.end(), ',') + 1;
+		string trailing(columns > 9 ? columns - 9 : 0, ',');
+
+		mergeRuns(runPaths, outputPath, [&](const Bid& bid) {
+			out << bid.title << ',' << bid.bidId << ",,," << '$' << bid.amount << ",,,," << bid.fund
+					<< trailing << '\n';
+			++written;
+		}, less);
+	}
+
+	return written;
+}
+
+/**
+ * Sort the bids by Compare, with the stable merge sort or the introsort
+ */
+template <typename Compare>
+void sortBy(vector<Bid>& bids, bool stable) {
+	if (stable)
+		stableSort<Compare>(bids);
+	else
+		quickSort<Compare>(bids, 0, (int) bids.size() - 1);
+}
+
+/**
+ * Put the first k bids by Compare in order
+ */
+template <typename Compare>
+void partialSortBy(vector<Bid>& bids, int k) {
+	partialSort<Compare>(bids, k);
+}
+
+/**
+ * The first k bids by Compare
+ */
+template <typename Compare>
+vector<Bid> topBy(const vector<Bid>& bids, int k) {
+	return topK<Compare>(bids, k);
+}
+
+/**
+ * Externally sort a bid file by Compare
+ */
+template <typename Compare>
+size_t externalSortBy(const string& csvPath, const string& outputPath, size_t memoryBudget, bool binaryOutput) {
+	return externalSort<Compare>(csvPath, outputPath, memoryBudget, binaryOutput);
+}
+
+/**
+ * A sort key the menu can pick at runtime, bound to its
+ * instantiations of the sorts
+ */
+struct SortField {
+	const char* name;
+	void (*sort)(vector<Bid>& bids, bool stable);
+	void (*partialSort)(vector<Bid>& bids, int k);
+	vector<Bid> (*top)(const vector<Bid>& bids, int k);
+	size_t (*externalSort)(const string& csvPath, const string& outputPath, size_t memoryBudget, bool binaryOutput);
+};
+
+template <typename Compare>
+SortField sortField(const char* name) {
+	return { name, sortBy<Compare>, partialSortBy<Compare>, topBy<Compare>, externalSortBy<Compare> };
+}
+
+const SortField SORT_FIELDS[] = {
+	sortField<ByTitle>("title"),
+	sortField<ByAmount>("amount"),
+	sortField<Descending<ByAmount>>("amount, descending"),
+	sortField<ByFund>("fund"),
+	sortField<ById>("bid id"),
+	sortField<ThenBy<ByFund, Descending<ByAmount>>>("fund, then amount descending"),
+	sortField<ThenBy<ByFund, ByTitle>>("fund, then title"),
+};
+
+const int SORT_FIELD_COUNT = sizeof(SORT_FIELDS) / sizeof(SORT_FIELDS[0]);
+
+/**
+ * Load a CSV file of bids into a compact store
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param store the store to fill (cleared first)
+ */
+void loadCompactBids(string csvPath, BidStore& store) {
+    cout << "Loading CSV file " << csvPath << endl;
+
+    store.Clear();
+
+    // initialize the CSV Parser using the given path
+    csv::Parser file = csv::Parser(csvPath);
+
+    try {
+        // loop to read rows of a CSV file
+        for (unsigned i = 0; i < file.rowCount(); i++) {
+            store.Add(bidFromRow(file[i]));
+        }
+    } catch (csv::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+
+    store.ShrinkToFit();
+}
+
+/**
+ * Load a CSV file of bids into a columnar table
+ *
+ * @param csvPath the path to the CSV file to load
+ * @param table the table to fill (cleared first)
+ */
+void loadBidTable(string csvPath, BidTable& table) {
+    cout << "Loading CSV file " << csvPath << endl;
+
+    table.Clear();
+
+    // initialize the CSV Parser using the given path
+    csv::Parser file = csv::Parser(csvPath);
+
+    try {
+        // loop to read rows of a CSV file
+        for (unsigned i = 0; i < file.rowCount(); i++) {
+            table.AddRow(bidFromRow(file[i]));
+        }
+    } catch (csv::Error &e) {
+        std::cerr << e.what() << std::endl;
+    }
+}
+
+/**
+ * Aggregate one batch of CSV lines: parse them, gather each group's
+ * amounts into a contiguous array, then summarize each array
+ *
+ * @param header the CSV header line
+ * @param batch the lines, newline separated
+ * @param groupColumn column to group by
+ * @return the batch's partial aggregate
+ */
+GroupAggregate aggregateBatch(const string& header, const string& batch, unsigned groupColumn) {
+	GroupAggregate partial;
+	vector<vector<double>> amounts;
+
+	try {
+		csv::Parser file = csv::Parser(header + "\n" + batch, csv::ePURE);
+
+		for (unsigned i = 0; i < file.rowCount(); i++) {
+			uint32_t group = partial.Group(file[i][groupColumn]);
+			if (group >= amounts.size()) {
+				amounts.resize(group + 1);
+			}
+			amounts[group].push_back(strToDouble(file[i][4], '$'));
+		}
+	} catch (csv::Error &e) {
+		std::cerr << e.what() << std::endl;
+	}
+
+	for (uint32_t group = 0; group < amounts.size(); ++group) {
+		partial.Add(group, summarizeAmounts(amounts[group].data(), amounts[group].size()));
+	}
+	return partial;
+}
 
-            // push this bid to the end
-            bids.push_back(bid);
-        }
-    } catch (csv::Error &e) {
-        std::cerr << e.what() << std::endl;
-    }
-    return bids;
+/**
+ * Find a column by its header name, ignoring surrounding whitespace
+ * (the eBid headers carry trailing spaces)
+ *
+ * @param header the CSV header line
+ * @param name the column name to look for
+ * @return the column's index, or -1 if there is none
+ */
+int findColumn(const string& header, const string& name) {
+	try {
+		csv::Parser file = csv::Parser(header, csv::ePURE);
+		vector<string> columns = file.getHeader();
+
+		for (unsigned i = 0; i < columns.size(); i++) {
+			size_t first = columns[i].find_first_not_of(" \t\r");
+			size_t last = columns[i].find_last_not_of(" \t\r");
+			if (first != string::npos && columns[i].compare(first, last - first + 1, name) == 0) {
+				return i;
+			}
+		}
+	} catch (csv::Error &e) {
+		std::cerr << e.what() << std::endl;
+	}
+	return -1;
 }
 
 /**
- * Partition the vector of bids into two parts, low and high
+ * Group a bid CSV by one column and aggregate the amounts, straight
+ * from the file: no container of bids is built. The file is read in
+ * AGGREGATE_BATCH_BYTES batches, each aggregated as a task on the pool,
+ * and the partial results are merged as they finish. At most two
+ * batches per thread are in flight, which bounds the memory used.
  *
- * @param bids Address of the vector<Bid> instance to be partitioned
- * @param begin Beginning index to partition
- * @param end Ending index to partition
+ * @param csvPath the CSV file to read
+ * @param groupName header name of the column to group by
+ * @param threads number of threads, including the caller
+ * @return the merged aggregate
  */
-int partition(vector<Bid>& bids, int begin, int end) {
-	// Pick the middle value as the pivot (Hoare scheme)
-	string pivotVal = bids[(begin + end) / 2].title;
+GroupAggregate aggregateAmounts(string csvPath, string groupName = "Fund", unsigned threads = 1) {
+	GroupAggregate total;
 
-	// Low and high
-	int low  = begin - 1;
-	int high =  end  + 1;
+	ifstream in(csvPath);
+	if (!in.is_open()) {
+		cout << "Failed to open " << csvPath << endl;
+		return total;
+	}
 
-	while (true) {
+	string header;
+	getline(in, header);
 
-		// Increment the low...
-		do {
-			++low;
-		} while (bids[low].title < pivotVal);
+	int found = findColumn(header, groupName);
+	if (found < 0) {
+		cout << "No " << groupName << " column in " << csvPath << endl;
+		return total;
+	}
+	unsigned groupColumn = found;
 
-		// And decrement the high...
-		do {
-			--high;
-		} while (bids[high].title > pivotVal);
+	WorkStealingPool pool(threads);
+	atomic<int> pending(0);
+	mutex totalLock;
+	int maxInFlight = 2 * pool.Size();
 
-		// Return when the two indices 'cross'
-		if (low >= high) {
-			return high;
+	string batch;
+	string line;
+
+	auto submit = [&]() {
+		if (batch.empty()) {
+			return;
 		}
 
-		// Swap the inverted pair (where the elements < the pivot & > the pivot are in the wrong order)
-		auto temp = bids[low];
-		bids[low] = bids[high];
-		bids[high] = temp;
-	}
+		// Help out rather than read further ahead than the threads can keep up with
+		while (pending.load() >= maxInFlight) {
+			if (!pool.RunPending()) {
+				this_thread::yield();
+			}
+		}
+
+		++pending;
+		pool.Submit([&header, &total, &totalLock, &pending, groupColumn, lines = move(batch)] {
+			GroupAggregate partial = aggregateBatch(header, lines, groupColumn);
+			{
+				lock_guard<mutex> guard(totalLock);
+				total.Merge(partial);
+			}
+			--pending;
+		});
+		batch.clear();
+	};
+
+	while (getline(in, line)) {
+		if (line.empty()) {
+			continue;
+		}
 
+		batch += line;
+		batch += '\n';
 
+		if (batch.size() >= AGGREGATE_BATCH_BYTES) {
+			submit();
+		}
+	}
+	submit();
 
+	pool.Wait(pending);
+	return total;
 }
 
 /**
- * Perform a quick sort on bid title
- * Average performance: O(n log(n))
- * Worst case performance O(n^2))
- *
- * @param bids address of the vector<Bid> instance to be sorted
- * @param begin the beginning index to sort on
- * @param end the ending index to sort on
+ * Rough bytes held by a vector of bids, counting string buffers
+ * too long for the strings' own small-string storage
  */
-void quickSort(vector<Bid>& bids, int begin, int end) {
-	if (begin < end) {
-		// Partition index
-		int p = partition(bids, begin, end);
-
-		// Sort before p
-		quickSort(bids, begin, p);
-
-		// Sort after p
-		quickSort(bids, p + 1, end);
+size_t bidMemoryUsage(const vector<Bid>& bids) {
+	size_t bytes = bids.capacity() * sizeof(Bid);
+	const string empty;
+
+	for (const Bid& bid : bids) {
+		for (const string* field : { &bid.bidId, &bid.title, &bid.fund }) {
+			if (field->capacity() > empty.capacity())
+				bytes += field->capacity() + 1;
+		}
 	}
+	return bytes;
 }
 
 /**
- * Perform a selection sort on bid title
- * Average performance: O(n^2))
- * Worst case performance O(n^2))
+ * List the sort keys and read the user's pick
  *
- * @param bid address of the vector<Bid>
- *            instance to be sorted
+ * @return index into SORT_FIELDS, or -1 if there is no such field
  */
-void selectionSort(vector<Bid>& bids) {
-	int size = bids.size();
-
-	// Then successively find the minimum and put it in its correct position
-	for (int i = 0; i < size - 1; ++i) {
-		// Operator [] preferred over bids.at() because the bounds-checking
-		// in the latter is not needed here (we know these indices are valid)
-
-		// set the current element as the min
-		int minIdx = i;
-
-		// Find the minimum in the unsorted part (i + 1 to end)
-		for (int j = i + 1; j < size; ++j)
-			if (bids[j].title < bids[minIdx].title)
-				// Reassign the min index if a lower value is found
-				minIdx = j;
-
-		// If the min index changed, swap the ith element with the minimum one
-		if (minIdx != i) {
-			auto temp = bids[minIdx];
-			bids[minIdx] = bids[i];
-			bids[i] = temp;
-		}
+int chooseSortField() {
+	for (int i = 0; i < SORT_FIELD_COUNT; ++i) {
+		cout << "  " << i + 1 << ". " << SORT_FIELDS[i].name << endl;
 	}
+	cout << "Sort by: ";
+	int field = 0;
+	cin >> field;
+	if (field < 1 || field > SORT_FIELD_COUNT) {
+		cout << "No such field" << endl;
+		return -1;
+	}
+	return field - 1;
 }
 
 /**
@@ -222,17 +2435,33 @@ int main(int argc, char* argv[]) {
 
     // process command line arguments
     string csvPath;
+    unsigned threadCount = thread::hardware_concurrency();
     switch (argc) {
     case 2:
         csvPath = argv[1];
         break;
+    case 3:
+        csvPath = argv[1];
+        threadCount = atoi(argv[2]);
+        break;
     default:
         csvPath = "eBid_Monthly_Sales.csv";
     }
 
+    // hardware_concurrency may not know
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
     // Define a vector to hold all the bids
     vector<Bid> bids;
 
+    // The same bids in compact form
+    BidStore compactBids;
+
+    // And column by column
+    BidTable bidTable;
+
     // Define a timer variable
     clock_t ticks;
 
@@ -243,6 +2472,21 @@ int main(int argc, char* argv[]) {
         cout << "  2. Display All Bids" << endl;
         cout << "  3. Selection Sort All Bids" << endl;
         cout << "  4. Quick Sort All Bids" << endl;
+        cout << "  5. Key Sort All Bids" << endl;
+        cout << "  6. Parallel Sort All Bids" << endl;
+        cout << "  7. Benchmark Sorts" << endl;
+        cout << "  8. Radix Sort All Bids By Title" << endl;
+        cout << "  10. Radix Sort All Bids By Id" << endl;
+        cout << "  11. Radix Sort All Bids By Amount" << endl;
+        cout << "  12. Sort All Bids By Field" << endl;
+        cout << "  13. Top K Bids By Field" << endl;
+        cout << "  14. External Sort Bid File By Field" << endl;
+        cout << "  15. Load Compact Bids" << endl;
+        cout << "  16. Display All Compact Bids" << endl;
+        cout << "  17. Sort Compact Bids By Title" << endl;
+        cout << "  18. Load Bid Table" << endl;
+        cout << "  19. Bid Table Amount Summary" << endl;
+        cout << "  20. Aggregate Amounts By Fund" << endl;
         cout << "  9. Exit" << endl;
         cout << "Enter choice: ";
         cin >> choice;
@@ -295,16 +2539,325 @@ int main(int argc, char* argv[]) {
         	ticks = clock();
 
         	// quicksort the vector
-        	quickSort(bids, 0, bids.size());
+        	quickSort(bids, 0, (int) bids.size() - 1);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 5:
+        	// Initialise a timer
+        	ticks = clock();
+
+        	// sort compact keys, then move the bids into place once
+        	keySort(bids);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 6: {
+        	// Wall time, because clock() adds up CPU time across threads
+        	auto start = chrono::steady_clock::now();
+
+        	// quicksort the vector on threadCount threads
+        	parallelSort(bids, threadCount);
+
+        	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        	cout << "threads: " << threadCount << "\n"
+        		<< "time: " << elapsed << " seconds" << endl;
+
+        	break;
+        }
+
+        case 7:
+        	// Speedup curve from 1 to threadCount threads
+        	benchmarkSorts(bids, threadCount);
+
+        	break;
+
+        case 8:
+        	// Initialise a timer
+        	ticks = clock();
+
+        	// MSD radix sort the vector by title
+        	titleRadixSort(bids);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 10:
+        	// Initialise a timer
+        	ticks = clock();
+
+        	// LSD radix sort the vector by numeric id
+        	idRadixSort(bids);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 11:
+        	// Initialise a timer
+        	ticks = clock();
+
+        	// LSD radix sort the vector by amount in cents
+        	amountRadixSort(bids);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 12: {
+        	// Pick a sort key
+        	int field = chooseSortField();
+        	if (field < 0) {
+        		break;
+        	}
+
+        	cout << "Stable? (1 = yes, 0 = no): ";
+        	int stable = 0;
+        	cin >> stable;
+
+        	// Initialise a timer
+        	ticks = clock();
+
+        	SORT_FIELDS[field].sort(bids, stable != 0);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+        }
+
+        case 13: {
+        	// Pick a sort key and how many bids
+        	int field = chooseSortField();
+        	if (field < 0) {
+        		break;
+        	}
+
+        	cout << "How many bids: ";
+        	int k = 0;
+        	cin >> k;
+
+        	cout << "Method (1 = bounded heap, 2 = partial sort in place): ";
+        	int method = 1;
+        	cin >> method;
+
+        	// Initialise a timer
+        	ticks = clock();
+
+        	vector<Bid> top;
+        	if (method == 2) {
+        		// Orders the first k of the vector itself
+        		SORT_FIELDS[field].partialSort(bids, k);
+        		top.assign(bids.begin(), bids.begin() + min(max(k, 0), (int) bids.size()));
+        	}
+        	else {
+        		top = SORT_FIELDS[field].top(bids, k);
+        	}
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	for (unsigned i = 0; i < top.size(); ++i) {
+        		displayBid(top[i]);
+        	}
+        	cout << endl;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+        }
+
+        case 14: {
+        	// Sorts the file on disk; the loaded bids are left alone
+        	int field = chooseSortField();
+        	if (field < 0) {
+        		break;
+        	}
+
+        	string outputPath;
+        	cout << "Output file: ";
+        	cin >> outputPath;
+
+        	cout << "Memory budget (MB): ";
+        	double budget = 0;
+        	cin >> budget;
+
+        	cout << "Binary output? (1 = yes, 0 = CSV): ";
+        	int binary = 0;
+        	cin >> binary;
+
+        	// Initialise a timer
+        	ticks = clock();
+
+        	size_t written = SORT_FIELDS[field].externalSort(csvPath, outputPath,
+        			(size_t) (budget * 1024 * 1024), binary != 0);
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	cout << written << " bids written to " << outputPath << endl;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+        }
+
+        case 15:
+            // Initialize a timer variable before loading bids
+            ticks = clock();
+
+            loadCompactBids(csvPath, compactBids);
+
+            cout << compactBids.Size() << " bids read" << endl;
+
+            // Calculate elapsed time and display result
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            // Compare with the vector<Bid> from option 1, if loaded
+            cout << "compact bids: " << compactBids.MemoryUsage() << " bytes" << endl;
+            if (!bids.empty()) {
+                cout << "vector<Bid>: " << bidMemoryUsage(bids) << " bytes" << endl;
+            }
+
+            break;
+
+        case 16:
+            // Loop and display the compact bids
+            for (size_t i = 0; i < compactBids.Size(); ++i) {
+                displayBid(compactBids.Expand(compactBids.Get(i)));
+            }
+            cout << endl;
+
+            break;
+
+        case 17:
+        	// Initialise a timer
+        	ticks = clock();
+
+        	compactBids.SortByTitle();
+
+        	// Calculate the elapsed time
+        	ticks = clock() - ticks;
+
+        	// Display the time taken (ticks & seconds)
+        	cout << "time: " << ticks << " clock ticks\n"
+        		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+        	break;
+
+        case 18:
+            // Initialize a timer variable before loading bids
+            ticks = clock();
+
+            loadBidTable(csvPath, bidTable);
+
+            cout << bidTable.RowCount() << " bids read" << endl;
+
+            // Calculate elapsed time and display result
+            ticks = clock() - ticks; // current clock ticks minus starting clock ticks
+            cout << "time: " << ticks << " clock ticks" << endl;
+            cout << "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
+
+            break;
+
+        case 19: {
+        	cout << "Amount threshold: ";
+        	double threshold = 0;
+        	cin >> threshold;
+
+        	// Initialise a timer
+        	ticks = clock();
+
+        	double sum = bidTable.SumAmount();
+        	double lowest = bidTable.MinAmount();
+        	double highest = bidTable.MaxAmount();
+        	vector<uint32_t> over = bidTable.RowsWithAmountAbove(threshold);
+        	vector<double> byFund = bidTable.SumAmountByFund();
 
         	// Calculate the elapsed time
         	ticks = clock() - ticks;
 
+        	cout << "total: " << sum << " | min: " << lowest << " | max: " << highest << endl;
+        	cout << over.size() << " bids over " << threshold << ", totalling " << bidTable.SumAmount(over) << endl;
+        	for (uint32_t fund = 0; fund < byFund.size(); ++fund) {
+        		cout << "  " << bidTable.FundName(fund) << ": " << byFund[fund] << endl;
+        	}
+
         	// Display the time taken (ticks & seconds)
         	cout << "time: " << ticks << " clock ticks\n"
         		<< "time: " << ticks * 1.0 / CLOCKS_PER_SEC << " seconds" << endl;
 
         	break;
+        }
+
+        case 20: {
+        	// Reads the file itself; nothing needs to be loaded
+        	auto start = chrono::steady_clock::now();
+
+        	GroupAggregate byFund = aggregateAmounts(csvPath, "Fund", threadCount);
+
+        	double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+        	// List the funds in name order
+        	vector<uint32_t> order(byFund.Size());
+        	for (uint32_t group = 0; group < order.size(); ++group)
+        		order[group] = group;
+        	sort(order.begin(), order.end(), [&byFund](uint32_t a, uint32_t b) {
+        		return byFund.Key(a) < byFund.Key(b);
+        	});
+
+        	cout << "fund | count | sum | avg | min | max" << endl;
+        	for (uint32_t group : order) {
+        		const AmountStats& stats = byFund.Stats(group);
+        		cout << byFund.Key(group) << " | " << stats.count << " | " << stats.sum << " | "
+        				<< stats.Average() << " | " << stats.min << " | " << stats.max << endl;
+        	}
+
+        	cout << "threads: " << threadCount << "\n"
+        		<< "time: " << elapsed << " seconds" << endl;
+
+        	break;
+        }
 
         }
     }